@@ -0,0 +1,264 @@
+// Headless benchmark for the sorting engine. Runs each algorithm through a
+// NullSink (no rendering, no delays) over a grid of sizes and input
+// distributions and prints CSV or JSON so results can be diffed between builds.
+//
+//   ./bench [--algos 1,2,...] [--sizes 100,1000,...] [--dists uniform,sorted,...]
+//           [--reps N] [--seed S] [--range LO,HI] [--swaps K]
+//           [--max-quadratic N] [--threads N] [--format csv|json] [--out FILE]
+//
+// Inputs come from input_gen.h: any of its distributions, values in
+// [0, n - 1] unless --range is given, and the same --seed for every
+// algorithm, so all of them sort identical arrays.
+// --threads sizes the task pool the parallel algorithms run on (default: one
+// per core), so runs with --threads 1 and --threads N show their speedup.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "input_gen.h"
+#include "sort_engine.h"
+
+namespace {
+
+std::vector<int> allAlgorithms() {
+    std::vector<int> algorithms(SORT_ALGORITHM_COUNT);
+    std::iota(algorithms.begin(), algorithms.end(), 1);
+    return algorithms;
+}
+
+struct BenchConfig {
+    std::vector<int> algorithms = allAlgorithms();
+    std::vector<std::size_t> sizes = {100, 1000, 10000, 100000, 1000000, 10000000};
+    std::vector<Distribution> distributions = {Distribution::Uniform, Distribution::Sorted, Distribution::Reversed,
+                                               Distribution::FewUnique, Distribution::OrganPipe};
+    int reps = 5;
+    uint64_t seed = 12345;
+    bool fixedRange = false;  // otherwise values lie in [0, n - 1]
+    int minValue = 0;
+    int maxValue = 0;
+    std::size_t swaps = 0;  // nearly-sorted; 0: n / 100
+    // Quadratic cases above this size are skipped; 1e7 bubble sort is ~1e14 steps.
+    std::size_t maxQuadratic = 20000;
+    unsigned threads = 0;  // 0: one per core
+    std::string format = "csv";
+    std::string outPath;
+};
+
+struct BenchResult {
+    int algorithm;
+    Distribution distribution;
+    std::size_t size;
+    int reps;
+    unsigned threads;
+    double meanNsPerElement;
+    double stddevNsPerElement;
+    double minNsPerElement;
+    OpCounters counts;
+    bool sorted;
+};
+
+InputSpec inputFor(Distribution distribution, std::size_t n, const BenchConfig& config) {
+    InputSpec spec;
+    spec.distribution = distribution;
+    spec.size = n;
+    spec.seed = config.seed;
+    spec.minValue = config.fixedRange ? config.minValue : 0;
+    spec.maxValue = config.fixedRange ? config.maxValue : static_cast<int>(std::max<std::size_t>(n, 1) - 1);
+    spec.swaps = config.swaps;
+    return spec;
+}
+
+// Cases that cost O(n^2): the three simple sorts always, and the Lomuto
+// quicksort (last-element pivot) whenever the input is presorted or has runs
+// of equal keys. Those also recurse n deep, so they must stay small. Uniform
+// input has runs of equal keys too once --range holds far fewer distinct
+// values than n.
+bool isQuadratic(int algorithm, Distribution distribution, std::size_t n, const BenchConfig& config) {
+    if (algorithm >= 1 && algorithm <= 3) return true;
+    if (algorithm != 5) return false;
+    if (distribution != Distribution::Uniform) return true;
+    if (!config.fixedRange) return false;
+    uint64_t distinct = static_cast<uint64_t>(std::abs(static_cast<int64_t>(config.maxValue) - config.minValue)) + 1;
+    return distinct < n / 16;
+}
+
+bool parseList(const std::string& text, std::vector<std::string>& out) {
+    out.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return !out.empty();
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        std::vector<std::string> items;
+        try {
+            if (arg == "--algos" && parseList(value, items)) {
+                config.algorithms.clear();
+                for (const auto& item : items) config.algorithms.push_back(std::stoi(item));
+            } else if (arg == "--sizes" && parseList(value, items)) {
+                config.sizes.clear();
+                for (const auto& item : items) config.sizes.push_back(static_cast<std::size_t>(std::stod(item)));
+            } else if (arg == "--dists" && parseList(value, items)) {
+                config.distributions.clear();
+                for (const auto& item : items) {
+                    Distribution distribution;
+                    if (!parseDistribution(item, distribution)) {
+                        std::cerr << "Unknown distribution " << item << std::endl;
+                        return false;
+                    }
+                    config.distributions.push_back(distribution);
+                }
+            } else if (arg == "--reps") {
+                config.reps = std::max(1, std::stoi(value));
+            } else if (arg == "--seed") {
+                config.seed = std::stoull(value);
+            } else if (arg == "--range" && parseList(value, items) && items.size() == 2) {
+                config.fixedRange = true;
+                config.minValue = std::stoi(items[0]);
+                config.maxValue = std::stoi(items[1]);
+            } else if (arg == "--swaps") {
+                config.swaps = static_cast<std::size_t>(std::stod(value));
+            } else if (arg == "--max-quadratic") {
+                config.maxQuadratic = static_cast<std::size_t>(std::stod(value));
+            } else if (arg == "--threads") {
+                config.threads = static_cast<unsigned>(std::max(1, std::stoi(value)));
+            } else if (arg == "--format" && (value == "csv" || value == "json")) {
+                config.format = value;
+            } else if (arg == "--out") {
+                config.outPath = value;
+            } else {
+                std::cerr << "Unknown or invalid option " << arg << " " << value << std::endl;
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    for (int algorithm : config.algorithms) {
+        if (algorithm < 1 || algorithm > SORT_ALGORITHM_COUNT) {
+            std::cerr << "Unknown algorithm " << algorithm << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+BenchResult runCase(int algorithm, Distribution distribution, std::size_t n, const BenchConfig& config) {
+    const std::vector<int> input = generateInput(inputFor(distribution, n, config));
+
+    BenchResult result{algorithm, distribution, n, config.reps, sharedTaskPool().concurrency(), 0, 0, 0, {}, true};
+    std::vector<int> arr;
+    std::vector<double> samples;
+    for (int rep = 0; rep < config.reps; ++rep) {
+        arr = input;
+        NullSink sink;
+        opCounters.reset();
+        auto start = std::chrono::steady_clock::now();
+        runSort(algorithm, arr, sink);
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+        samples.push_back(elapsed.count() / std::max<std::size_t>(n, 1));
+        if (rep == 0) result.counts = opCounters;
+    }
+    result.sorted = std::is_sorted(arr.begin(), arr.end());
+    if (!result.sorted) {
+        std::cerr << sortAlgorithmName(algorithm) << " produced unsorted output on " << distributionName(distribution) << " n=" << n << std::endl;
+    }
+
+    double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    double variance = 0;
+    for (double s : samples) variance += (s - mean) * (s - mean);
+    variance /= samples.size() > 1 ? samples.size() - 1 : 1;
+
+    result.meanNsPerElement = mean;
+    result.stddevNsPerElement = std::sqrt(variance);
+    result.minNsPerElement = *std::min_element(samples.begin(), samples.end());
+    return result;
+}
+
+void writeCsv(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "algorithm,distribution,size,reps,threads,mean_ns_per_element,stddev_ns_per_element,min_ns_per_element,comparisons,swaps,writes,aux_bytes,allocations,max_depth,sorted\n";
+    for (const auto& r : results) {
+        out << sortAlgorithmName(r.algorithm) << ',' << distributionName(r.distribution) << ',' << r.size << ',' << r.reps << ',' << r.threads << ','
+            << r.meanNsPerElement << ',' << r.stddevNsPerElement << ',' << r.minNsPerElement << ','
+            << r.counts.comparisons << ',' << r.counts.swaps << ',' << r.counts.writes << ','
+            << r.counts.auxBytes << ',' << r.counts.allocations << ',' << r.counts.maxDepth << ',' << (r.sorted ? "true" : "false") << '\n';
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "[\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "  {\"algorithm\": \"" << sortAlgorithmName(r.algorithm) << "\", \"distribution\": \"" << distributionName(r.distribution)
+            << "\", \"size\": " << r.size << ", \"reps\": " << r.reps << ", \"threads\": " << r.threads
+            << ", \"mean_ns_per_element\": " << r.meanNsPerElement
+            << ", \"stddev_ns_per_element\": " << r.stddevNsPerElement
+            << ", \"min_ns_per_element\": " << r.minNsPerElement
+            << ", \"comparisons\": " << r.counts.comparisons << ", \"swaps\": " << r.counts.swaps
+            << ", \"writes\": " << r.counts.writes << ", \"aux_bytes\": " << r.counts.auxBytes
+            << ", \"allocations\": " << r.counts.allocations << ", \"max_depth\": " << r.counts.maxDepth
+            << ", \"sorted\": " << (r.sorted ? "true" : "false") << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) return 1;
+    if (config.threads) resizeSharedTaskPool(config.threads);
+
+    std::vector<BenchResult> results;
+    for (int algorithm : config.algorithms) {
+        for (Distribution distribution : config.distributions) {
+            for (std::size_t n : config.sizes) {
+                if (isQuadratic(algorithm, distribution, n, config) && n > config.maxQuadratic) {
+                    std::cerr << "skip " << sortAlgorithmName(algorithm) << " " << distributionName(distribution) << " n=" << n
+                              << " (quadratic, above --max-quadratic)" << std::endl;
+                    continue;
+                }
+                std::cerr << "run  " << sortAlgorithmName(algorithm) << " " << distributionName(distribution) << " n=" << n << std::endl;
+                results.push_back(runCase(algorithm, distribution, n, config));
+            }
+        }
+    }
+
+    std::ofstream file;
+    if (!config.outPath.empty()) {
+        file.open(config.outPath);
+        if (!file) {
+            std::cerr << "Could not open " << config.outPath << " for writing" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = config.outPath.empty() ? std::cout : file;
+    if (config.format == "json") {
+        writeJson(out, results);
+    } else {
+        writeCsv(out, results);
+    }
+    // Every case still gets written, but a wrong sort fails the run.
+    bool allSorted = std::all_of(results.begin(), results.end(), [](const BenchResult& r) { return r.sorted; });
+    return allSorted ? 0 : 1;
+}
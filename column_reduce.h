@@ -0,0 +1,133 @@
+#pragma once
+
+// Reduces an array to one min/max pair per pixel column, so arrays far wider
+// than the window can be drawn in O(columns) once a single O(n) pass has run.
+// The inner min/max loop uses AVX2 or SSE2 when the compiler targets them and
+// plain scalar code otherwise; all three give identical results.
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COLUMN_REDUCE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#define COLUMN_REDUCE_SSE2 1
+#endif
+
+struct ColumnSpan {
+    int lo;
+    int hi;
+};
+
+// First element of column c when n elements are spread over `columns` columns.
+inline std::size_t columnStart(std::size_t c, std::size_t n, std::size_t columns) {
+    return static_cast<std::size_t>(static_cast<uint64_t>(c) * n / columns);
+}
+
+#ifdef COLUMN_REDUCE_SSE2
+// SSE2 has no 32-bit signed min/max; SSE4.1 does.
+inline __m128i minEpi32(__m128i a, __m128i b) {
+#ifdef __SSE4_1__
+    return _mm_min_epi32(a, b);
+#else
+    __m128i greater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+#endif
+}
+
+inline __m128i maxEpi32(__m128i a, __m128i b) {
+#ifdef __SSE4_1__
+    return _mm_max_epi32(a, b);
+#else
+    __m128i greater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+#endif
+}
+#endif
+
+// Minimum and maximum of p[0..count); count must be at least 1.
+inline ColumnSpan minMaxSpan(const int* p, std::size_t count) {
+    ColumnSpan span = {INT_MAX, INT_MIN};
+    std::size_t i = 0;
+#if defined(COLUMN_REDUCE_AVX2)
+    if (count >= 16) {
+        __m256i lo = _mm256_set1_epi32(INT_MAX);
+        __m256i hi = _mm256_set1_epi32(INT_MIN);
+        for (; i + 8 <= count; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            lo = _mm256_min_epi32(lo, v);
+            hi = _mm256_max_epi32(hi, v);
+        }
+        alignas(32) int los[8], his[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(los), lo);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(his), hi);
+        for (int k = 0; k < 8; ++k) {
+            span.lo = std::min(span.lo, los[k]);
+            span.hi = std::max(span.hi, his[k]);
+        }
+    }
+#elif defined(COLUMN_REDUCE_SSE2)
+    if (count >= 8) {
+        __m128i lo = _mm_set1_epi32(INT_MAX);
+        __m128i hi = _mm_set1_epi32(INT_MIN);
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            lo = minEpi32(lo, v);
+            hi = maxEpi32(hi, v);
+        }
+        alignas(16) int los[4], his[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(los), lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(his), hi);
+        for (int k = 0; k < 4; ++k) {
+            span.lo = std::min(span.lo, los[k]);
+            span.hi = std::max(span.hi, his[k]);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        span.lo = std::min(span.lo, p[i]);
+        span.hi = std::max(span.hi, p[i]);
+    }
+    return span;
+}
+
+// Half-open range of array indices or of columns.
+struct IndexRange {
+    std::size_t begin;
+    std::size_t end;
+};
+
+// Columns whose envelopes include any element of `elements`, out of n
+// elements spread over `columns` columns.
+inline IndexRange columnsCovering(IndexRange elements, std::size_t n, std::size_t columns) {
+    if (n == 0 || elements.begin >= elements.end) return {0, 0};
+    std::size_t first = static_cast<std::size_t>(static_cast<uint64_t>(elements.begin) * columns / n);
+    std::size_t last = static_cast<std::size_t>((static_cast<uint64_t>(elements.end) * columns + n - 1) / n);
+    return {first, std::min(last, columns)};
+}
+
+// Recomputes the envelopes of the columns in `range`; out must already hold
+// `columns` entries. When there are fewer elements than columns an element is
+// repeated across the columns it covers.
+inline void reduceColumns(const std::vector<int>& arr, std::size_t columns, std::vector<ColumnSpan>& out, IndexRange range) {
+    std::size_t n = arr.size();
+    for (std::size_t c = range.begin; c < std::min(range.end, out.size()); ++c) {
+        std::size_t start = columnStart(c, n, columns);
+        std::size_t end = std::max(columnStart(c + 1, n, columns), start + 1);
+        out[c] = minMaxSpan(arr.data() + start, end - start);
+    }
+}
+
+// Fills out with `columns` envelopes of arr.
+inline void reduceColumns(const std::vector<int>& arr, std::size_t columns, std::vector<ColumnSpan>& out) {
+    out.resize(arr.empty() ? 0 : columns);
+    reduceColumns(arr, columns, out, {0, columns});
+}
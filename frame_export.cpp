@@ -0,0 +1,238 @@
+#include "frame_export.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+void putBe32(std::vector<uint8_t>& buf, uint32_t v) {
+    for (int i = 3; i >= 0; --i) buf.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+uint32_t crc32(const uint8_t* p, std::size_t n, uint32_t crc = 0) {
+    static const auto table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Appends a PNG chunk: length, type, data, CRC over type and data.
+void putChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, std::size_t n) {
+    putBe32(out, static_cast<uint32_t>(n));
+    std::size_t typeAt = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + n);
+    putBe32(out, crc32(out.data() + typeAt, n + 4));
+}
+
+// BT.601 studio-range RGB -> YCbCr, the colorimetry Y4M readers assume.
+inline uint8_t lumaOf(uint32_t px) {
+    int r = (px >> 16) & 0xFF, g = (px >> 8) & 0xFF, b = px & 0xFF;
+    return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline uint8_t cbOf(uint32_t px) {
+    int r = (px >> 16) & 0xFF, g = (px >> 8) & 0xFF, b = px & 0xFF;
+    return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline uint8_t crOf(uint32_t px) {
+    int r = (px >> 16) & 0xFF, g = (px >> 8) & 0xFF, b = px & 0xFF;
+    return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+// Writes an IDAT-sized chunk straight to the file instead of copying it.
+void putChunkTo(std::ofstream& out, const char type[4], const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> head;
+    putBe32(head, static_cast<uint32_t>(data.size()));
+    head.insert(head.end(), type, type + 4);
+    std::vector<uint8_t> tail;
+    putBe32(tail, crc32(data.data(), data.size(), crc32(head.data() + 4, 4)));
+    out.write(reinterpret_cast<const char*>(head.data()), head.size());
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    out.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+}
+
+}  // namespace
+
+FrameExporter::FrameExporter(const std::string& path, FrameFormat format, int width, int height, int fps, std::size_t queueDepth)
+    : path(path), format(format), frameWidth(width), frameHeight(height), fps(std::max(fps, 1)) {
+    queueDepth = std::max<std::size_t>(queueDepth, 2);
+    buffers.resize(queueDepth, std::vector<uint32_t>(static_cast<std::size_t>(width) * height));
+    for (std::size_t i = 0; i < queueDepth; ++i) freeBuffers.push_back(i);
+
+    if (format == FrameFormat::Y4M) {
+        stream.open(path, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            // The writer still runs so buffers keep cycling; frames are dropped.
+            errorMessage = "Could not open " + path + " for writing";
+            failed = true;
+        }
+        std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) + " F" +
+                             std::to_string(this->fps) + ":1 Ip A1:1 C444\n";
+        stream.write(header.data(), header.size());
+    }
+    writer = std::thread(&FrameExporter::run, this);
+}
+
+FrameExporter::~FrameExporter() {
+    finish();
+}
+
+std::vector<uint32_t>& FrameExporter::acquire() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return !freeBuffers.empty(); });
+    current = freeBuffers.back();
+    freeBuffers.pop_back();
+    acquired = true;
+    return buffers[current];
+}
+
+void FrameExporter::submit() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!acquired) return;
+        acquired = false;
+        queued.push_back(current);
+    }
+    cv.notify_all();
+}
+
+bool FrameExporter::finish() {
+    if (finished) return !failed;
+    finished = true;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (writer.joinable()) writer.join();
+    if (stream.is_open()) {
+        stream.close();
+        if (stream.fail() && !failed) {
+            errorMessage = "Failed while writing " + path;
+            failed = true;
+        }
+    }
+    return !failed;
+}
+
+void FrameExporter::run() {
+    for (uint64_t index = 0;; ++index) {
+        std::size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return stopping || !queued.empty(); });
+            if (queued.empty()) return;
+            slot = queued.front();
+            queued.pop_front();
+        }
+        // Once a write has failed the rest are dropped, but buffers keep
+        // cycling so the render loop never blocks on a dead writer.
+        if (!failed && !writeFrame(buffers[slot], index)) failed = true;
+        if (!failed) ++written;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            freeBuffers.push_back(slot);
+        }
+        cv.notify_all();
+    }
+}
+
+bool FrameExporter::writeFrame(const std::vector<uint32_t>& pixels, uint64_t index) {
+    if (format == FrameFormat::Y4M) return writeY4m(pixels);
+
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "_%06llu.png", static_cast<unsigned long long>(index));
+    return writePng(pixels, path + suffix);
+}
+
+bool FrameExporter::writeY4m(const std::vector<uint32_t>& pixels) {
+    std::size_t plane = pixels.size();
+    scratch.resize(plane * 3);
+    uint8_t* y = scratch.data();
+    uint8_t* cb = y + plane;
+    uint8_t* cr = cb + plane;
+    for (std::size_t i = 0; i < plane; ++i) {
+        y[i] = lumaOf(pixels[i]);
+        cb[i] = cbOf(pixels[i]);
+        cr[i] = crOf(pixels[i]);
+    }
+    stream.write("FRAME\n", 6);
+    stream.write(reinterpret_cast<const char*>(scratch.data()), scratch.size());
+    if (!stream) errorMessage = "Failed while writing " + path;
+    return static_cast<bool>(stream);
+}
+
+bool FrameExporter::writePng(const std::vector<uint32_t>& pixels, const std::string& filePath) {
+    // Raw image: a filter byte (0, none) and then RGB for each row.
+    std::size_t rowBytes = static_cast<std::size_t>(frameWidth) * 3 + 1;
+    raw.resize(rowBytes * frameHeight);
+    for (int y = 0; y < frameHeight; ++y) {
+        uint8_t* out = raw.data() + y * rowBytes;
+        const uint32_t* in = pixels.data() + static_cast<std::size_t>(y) * frameWidth;
+        *out++ = 0;
+        for (int x = 0; x < frameWidth; ++x) {
+            *out++ = static_cast<uint8_t>(in[x] >> 16);
+            *out++ = static_cast<uint8_t>(in[x] >> 8);
+            *out++ = static_cast<uint8_t>(in[x]);
+        }
+    }
+
+    // zlib stream: header, stored blocks of up to 64 KiB, Adler-32 of raw.
+    const std::size_t MAX_STORED_BLOCK = 65535;
+    scratch.clear();
+    scratch.reserve(raw.size() + raw.size() / MAX_STORED_BLOCK * 5 + 16);
+    scratch.push_back(0x78);
+    scratch.push_back(0x01);
+    std::size_t offset = 0;
+    do {
+        std::size_t len = std::min(raw.size() - offset, MAX_STORED_BLOCK);
+        bool last = offset + len == raw.size();
+        scratch.push_back(last ? 1 : 0);
+        scratch.push_back(static_cast<uint8_t>(len));
+        scratch.push_back(static_cast<uint8_t>(len >> 8));
+        scratch.push_back(static_cast<uint8_t>(~len));
+        scratch.push_back(static_cast<uint8_t>(~len >> 8));
+        scratch.insert(scratch.end(), raw.begin() + offset, raw.begin() + offset + len);
+        offset += len;
+    } while (offset < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (std::size_t i = 0; i < raw.size();) {
+        // 5552 bytes is the most that can be summed before b may overflow.
+        std::size_t chunkEnd = std::min(raw.size(), i + 5552);
+        for (; i < chunkEnd; ++i) {
+            a += raw[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    putBe32(scratch, (b << 16) | a);
+
+    std::vector<uint8_t> header = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> ihdr;
+    putBe32(ihdr, static_cast<uint32_t>(frameWidth));
+    putBe32(ihdr, static_cast<uint32_t>(frameHeight));
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});  // 8-bit RGB, no interlace
+    putChunk(header, "IHDR", ihdr.data(), ihdr.size());
+
+    std::vector<uint8_t> trailer;
+    putChunk(trailer, "IEND", nullptr, 0);
+
+    std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    putChunkTo(out, "IDAT", scratch);
+    out.write(reinterpret_cast<const char*>(trailer.data()), trailer.size());
+    if (!out) errorMessage = "Failed while writing " + filePath;
+    return static_cast<bool>(out);
+}
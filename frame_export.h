@@ -0,0 +1,83 @@
+#pragma once
+
+// Asynchronous frame export. The render loop fills ARGB8888 frames and hands
+// them to a FrameExporter; a writer thread encodes and writes them, so disk
+// and encoding time only ever hold up the render loop, never the sorts. The
+// frame buffers form a fixed pool of `queueDepth` entries: once they are all
+// queued, acquire() blocks until the writer returns one, which bounds both
+// memory use and how far the writer can fall behind.
+//
+// Formats:
+//   Y4M  one uncompressed YUV4MPEG2 stream (4:4:4, BT.601 studio range) that
+//        ffmpeg and most players read directly.
+//   PNG  one file per frame, <prefix>_000000.png, <prefix>_000001.png, ...
+//        written as stored (uncompressed) deflate blocks, so no zlib is needed.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class FrameFormat { Y4M, PNG };
+
+class FrameExporter {
+public:
+    // For Y4M `path` is the output file; for PNG it is the file name prefix.
+    FrameExporter(const std::string& path, FrameFormat format, int width, int height, int fps, std::size_t queueDepth = 8);
+    ~FrameExporter();
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    // Returns a width x height ARGB8888 buffer (pitch width * 4) to fill, then
+    // submit() queues it. Blocks while every buffer is waiting to be written.
+    std::vector<uint32_t>& acquire();
+    void submit();
+
+    // Writes the queued frames and stops the writer thread. Returns false if
+    // any frame could not be written.
+    bool finish();
+
+    bool ok() const { return !failed; }
+    // Only meaningful once finish() has returned.
+    const std::string& error() const { return errorMessage; }
+    int width() const { return frameWidth; }
+    int height() const { return frameHeight; }
+    uint64_t framesWritten() const { return written; }
+
+private:
+    void run();
+    bool writeFrame(const std::vector<uint32_t>& pixels, uint64_t index);
+    bool writeY4m(const std::vector<uint32_t>& pixels);
+    bool writePng(const std::vector<uint32_t>& pixels, const std::string& filePath);
+
+    std::string path;
+    FrameFormat format;
+    int frameWidth;
+    int frameHeight;
+    int fps;
+    std::ofstream stream;  // Y4M only
+
+    std::vector<std::vector<uint32_t>> buffers;
+    std::vector<std::size_t> freeBuffers;
+    std::deque<std::size_t> queued;
+    std::size_t current = 0;
+    bool acquired = false;
+    bool stopping = false;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread writer;
+
+    // Owned by the writer thread until finish() joins it.
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> scratch;
+    std::string errorMessage;
+    std::atomic<uint64_t> written{0};
+    std::atomic<bool> failed{false};
+    bool finished = false;
+};
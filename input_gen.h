@@ -0,0 +1,224 @@
+#pragma once
+
+// Input arrays for the visualizer and the benchmark. Every array comes from a
+// named distribution, a size, a value range and an explicit 64-bit seed, so
+// the same seed gives every window of a multi-window run (and every build of
+// the benchmark) exactly the same input. The generator is xoshiro256**,
+// seeded through splitmix64; each call builds its own, so generating is
+// thread-safe, and threadRng() gives each thread its own stream for drawing
+// fresh seeds.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+inline uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** (Blackman, Vigna). Meets UniformRandomBitGenerator, so it also
+// works with the <random> distributions.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed) {
+        for (uint64_t& word : s) word = splitMix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type{0}; }
+
+    result_type operator()() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound), without modulo bias (Lemire's multiply-shift).
+    uint64_t below(uint64_t bound) {
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 m = static_cast<unsigned __int128>((*this)()) * bound;
+        uint64_t low = static_cast<uint64_t>(m);
+        if (low < bound) {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                m = static_cast<unsigned __int128>((*this)()) * bound;
+                low = static_cast<uint64_t>(m);
+            }
+        }
+        return static_cast<uint64_t>(m >> 64);
+#else
+        uint64_t threshold = (0 - bound) % bound;
+        uint64_t r;
+        do {
+            r = (*this)();
+        } while (r < threshold);
+        return r % bound;
+#endif
+    }
+
+    // Uniform in [0, 1).
+    double unit() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s[4];
+};
+
+// This thread's generator, for drawing seeds. Every thread gets a different
+// stream; none of them is reproducible, which is the point.
+inline Xoshiro256& threadRng() {
+    static std::atomic<uint64_t> streams{(static_cast<uint64_t>(std::random_device{}()) << 32) ^
+                                         static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())};
+    thread_local Xoshiro256 rng(streams.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed));
+    return rng;
+}
+
+enum class Distribution { Uniform, Zipf, Sorted, Reversed, Sawtooth, OrganPipe, FewUnique, NearlySorted, Count };
+
+inline const char* distributionName(Distribution d) {
+    static const char* const names[] = {"uniform", "zipf", "sorted", "reversed", "sawtooth", "organ-pipe", "few-unique", "nearly-sorted"};
+    return d < Distribution::Count ? names[static_cast<int>(d)] : "unknown";
+}
+
+// Accepts the names above; "random" is kept as another name for uniform.
+inline bool parseDistribution(const std::string& name, Distribution& out) {
+    if (name == "random") {
+        out = Distribution::Uniform;
+        return true;
+    }
+    for (int d = 0; d < static_cast<int>(Distribution::Count); ++d) {
+        if (name == distributionName(static_cast<Distribution>(d))) {
+            out = static_cast<Distribution>(d);
+            return true;
+        }
+    }
+    return false;
+}
+
+struct InputSpec {
+    Distribution distribution = Distribution::Uniform;
+    std::size_t size = 0;
+    int minValue = 0;  // values lie in [minValue, maxValue]
+    int maxValue = 99;
+    uint64_t seed = 0;
+    double zipfSkew = 1.0;          // zipf: P(k-th most common value) ~ 1 / k^skew
+    int teeth = 4;                  // sawtooth: ascending ramps
+    int uniqueValues = 8;           // few-unique: distinct values
+    std::size_t swaps = 0;          // nearly-sorted: random swaps; 0 means size / 100
+};
+
+// Zipf ranks in [1, n] by rejection-inversion (Hörmann, Derflinger): constant
+// time per sample and no table, so n may be as large as the value range.
+class ZipfSampler {
+public:
+    ZipfSampler(double n, double skew)
+        : skew(skew), n(n), hIntegralX1(hIntegral(1.5) - 1.0), hIntegralN(hIntegral(n + 0.5)),
+          shortcut(2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0))) {}
+
+    uint64_t operator()(Xoshiro256& rng) const {
+        while (true) {
+            double u = hIntegralN + rng.unit() * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            double k = std::clamp(std::floor(x + 0.5), 1.0, n);
+            if (k - x <= shortcut || u >= hIntegral(k + 0.5) - h(k)) return static_cast<uint64_t>(k);
+        }
+    }
+
+private:
+    // log1p(x) / x and expm1(x) / x, continuous at 0.
+    static double log1pOverX(double x) { return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x / 2.0; }
+    static double expm1OverX(double x) { return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x / 2.0; }
+
+    double h(double x) const { return std::exp(-skew * std::log(x)); }
+    double hIntegral(double x) const {
+        double logX = std::log(x);
+        return expm1OverX((1.0 - skew) * logX) * logX;
+    }
+    double hIntegralInverse(double x) const {
+        double t = std::max(x * (1.0 - skew), -1.0);
+        return std::exp(log1pOverX(t) * x);
+    }
+
+    double skew;
+    double n;
+    double hIntegralX1;
+    double hIntegralN;
+    double shortcut;
+};
+
+inline std::vector<int> generateInput(const InputSpec& spec) {
+    std::size_t n = spec.size;
+    std::vector<int> arr(n);
+    if (n == 0) return arr;
+    Xoshiro256 rng(spec.seed);
+    int64_t lo = std::min(spec.minValue, spec.maxValue);
+    uint64_t span = static_cast<uint64_t>(std::max(spec.minValue, spec.maxValue) - lo) + 1;
+    // Maps step i of `steps` evenly onto the value range. i < 2^31 and
+    // span <= 2^32, so the product fits.
+    auto scaled = [&](std::size_t i, std::size_t steps) {
+        return static_cast<int>(lo + static_cast<int64_t>(static_cast<uint64_t>(i) * span / std::max<std::size_t>(steps, 1)));
+    };
+
+    switch (spec.distribution) {
+        case Distribution::Uniform:
+        case Distribution::Count:
+            for (int& v : arr) v = static_cast<int>(lo + static_cast<int64_t>(rng.below(span)));
+            break;
+        case Distribution::Zipf: {
+            // Rank 1, the most common value, is minValue.
+            ZipfSampler zipf(static_cast<double>(span), spec.zipfSkew);
+            for (int& v : arr) v = static_cast<int>(lo + static_cast<int64_t>(zipf(rng)) - 1);
+            break;
+        }
+        case Distribution::Sorted:
+        case Distribution::NearlySorted:
+            for (std::size_t i = 0; i < n; ++i) arr[i] = scaled(i, n);
+            if (spec.distribution == Distribution::NearlySorted) {
+                std::size_t swaps = spec.swaps ? spec.swaps : std::max<std::size_t>(n / 100, 1);
+                for (std::size_t k = 0; k < swaps; ++k) {
+                    // Drawn in a fixed order: argument evaluation order is unspecified.
+                    std::size_t i = rng.below(n);
+                    std::size_t j = rng.below(n);
+                    std::swap(arr[i], arr[j]);
+                }
+            }
+            break;
+        case Distribution::Reversed:
+            for (std::size_t i = 0; i < n; ++i) arr[i] = scaled(n - 1 - i, n);
+            break;
+        case Distribution::Sawtooth: {
+            std::size_t tooth = (n + std::max(spec.teeth, 1) - 1) / std::max(spec.teeth, 1);
+            for (std::size_t i = 0; i < n; ++i) arr[i] = scaled(i % tooth, tooth);
+            break;
+        }
+        case Distribution::OrganPipe: {
+            std::size_t half = (n + 1) / 2;
+            for (std::size_t i = 0; i < n; ++i) arr[i] = scaled(std::min(i, n - 1 - i), half);
+            break;
+        }
+        case Distribution::FewUnique: {
+            std::size_t unique = static_cast<std::size_t>(std::clamp<int64_t>(spec.uniqueValues, 1, static_cast<int64_t>(std::min<uint64_t>(span, 1u << 30))));
+            for (int& v : arr) v = scaled(rng.below(unique), unique);
+            break;
+        }
+    }
+    return arr;
+}
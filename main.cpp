@@ -4,13 +4,22 @@
 #include <iostream>
 #include <vector>
 #include <cstdlib>
-#include <ctime>
 #include <thread>
 #include <string>
 #include <algorithm>
 #include <mutex>
-#include <condition_variable>
+#include <atomic>
 #include <limits>
+#include <chrono>
+#include <bit>
+
+#include "column_reduce.h"
+#include "frame_export.h"
+#include "input_gen.h"
+#include "sort_engine.h"
+#include "span_fill.h"
+#include "step_trace.h"
+#include "triple_buffer.h"
 
 using namespace std;
 
@@ -34,22 +43,190 @@ void clearScreen() {
 }
 #endif
 
+// All visualizations share one window and one renderer. Each one is drawn into
+// its own tile (viewport) of TILE_HEIGHT rows; up to three tiles are stacked
+// full width, more than that are laid out in two columns.
 const int WINDOW_WIDTH = 1400;
-const int WINDOW_HEIGHT = 230;
+const int TILE_HEIGHT = 230;
 const int BAR_GAP = 5;
-const int MAX_VISUALIZATIONS = 3;
+const int MAX_VISUALIZATIONS = 6;
+const int MAX_SINGLE_COLUMN_TILES = 3;
+// Bars narrower than this get no value label; the digits would overlap.
+const int MIN_LABELLED_BAR_WIDTH = 12;
+// Below this bar width the array is drawn as per-column min/max envelopes.
+const int MIN_BAR_WIDTH = 2;
+
+// Input of the visualizations. Only changed from the menu, between runs. A
+// seed of 0 means a fresh seed for every run; either way all windows of one
+// run sort the same array.
+const int MAX_ARRAY_SIZE = 10000000;
+InputSpec inputSpec = [] {
+    InputSpec spec;
+    spec.size = 70;
+    return spec;
+}();
+
+uint64_t runSeed() {
+    return inputSpec.seed ? inputSpec.seed : threadRng()();
+}
+
+std::vector<int> makeInput(uint64_t seed, size_t size = inputSpec.size) {
+    InputSpec spec = inputSpec;
+    spec.seed = seed;
+    spec.size = size;
+    return generateInput(spec);
+}
 
-SDL_Window* windows[6] = {nullptr};
-SDL_Renderer* renderers[6] = {nullptr};
+// How bar-mode tiles are drawn. BACKEND_RECTS submits batched SDL_RenderFillRects
+// calls into a render-target texture; BACKEND_PIXELS rasterizes the bars on the
+// CPU into a streaming texture, which the software renderer handles far better.
+// Column mode always uses a streaming texture. Only changed from the menu.
+enum RenderBackend { BACKEND_RECTS, BACKEND_PIXELS };
+RenderBackend renderBackend = BACKEND_RECTS;
+
+struct Tile {
+    int slot;  // algorithm option - 1; indexes views[] and barBatches[]
+    SDL_Rect rect;
+};
+
+SDL_Window* window = nullptr;
+SDL_Renderer* renderer = nullptr;
+// Target of the software renderer when exporting without a display.
+SDL_Surface* offscreenSurface = nullptr;
+std::vector<Tile> tiles;
 TTF_Font* font = nullptr;
 
-bool quit = false;
-bool paused = false;
-int delay = 100;
+// Pre-rasterized strip of the printable ASCII range, built once per renderer.
+// Bar labels and the HUD are drawn as sub-rect copies out of it instead of
+// rasterizing and uploading a fresh texture for every string on every frame.
+const char ATLAS_FIRST = ' ';
+const char ATLAS_LAST = '~';
+const int ATLAS_GLYPH_COUNT = ATLAS_LAST - ATLAS_FIRST + 1;
+
+struct GlyphAtlas {
+    SDL_Texture* texture = nullptr;
+    SDL_Rect glyphs[ATLAS_GLYPH_COUNT] = {};
+};
+
+GlyphAtlas atlas;
+
+// Bars are grouped by colour and submitted with one SDL_RenderFillRects per
+// group. The rect vectors live per tile and keep their capacity across frames.
+enum BarBucket { BAR_NORMAL, BAR_CURRENT, BAR_SECOND, BAR_STAGE, BAR_BUCKETS };
+
+const SDL_Color BUCKET_COLORS[BAR_BUCKETS] = {
+    {0x00, 0xFF, 0x00, 0xFF},  // normal: green
+    {0xFF, 0x00, 0x00, 0xFF},  // current: red
+    {0x00, 0x00, 0xFF, 0xFF},  // second: blue
+    {0x00, 0x80, 0x00, 0xFF},  // upper side of a network stage: dark green
+};
+
+struct BarBatch {
+    std::vector<SDL_Rect> rects[BAR_BUCKETS];
+};
+
+BarBatch barBatches[SORT_ALGORITHM_COUNT];
+
+// Persistent image of one tile. Bars are drawn into a render-target texture
+// and column envelopes into a streaming texture; each frame only what changed
+// since the frame the canvas shows is repainted, then the texture is copied
+// into the window. The scratch vectors keep their capacity across frames.
+struct TileCanvas {
+    SDL_Texture* texture = nullptr;
+    int access = -1;
+    int width = 0;
+    int height = 0;
+    uint64_t sequence = 0;  // frame the texture shows; 0 forces a full repaint
+    size_t currentIndex = -1;
+    size_t secondIndex = -1;
+    std::vector<IndexRange> repaint;
+    std::vector<SDL_Rect> strips;
+    std::vector<int> solidTop;
+    std::vector<int> envelopeTop;
+    std::vector<Uint32> solidColor;
+    std::vector<Uint32> envelopeColor;
+};
+
+TileCanvas tileCanvases[SORT_ALGORITHM_COUNT];
+
+// Control state. Only the main thread pumps SDL events and writes these; the
+// sort threads read them lock-free at every bail-out point.
+std::atomic<bool> quit{false};
+std::atomic<bool> paused{false};
+// How fast the sort threads advance. Rendering runs separately at the display
+// refresh rate, so above that rate several steps land in each frame.
+std::atomic<int> stepsPerSecond{10};
+const int MAX_STEPS_PER_SECOND = 1000000000;
+
+// Refresh rate of the display the window opens on, queried by init. When
+// exporting it is the export frame rate instead.
+int displayRefreshRate = 60;
+const int MAX_EXPORT_FPS = 240;
+
+// Pending replay seek, set by handleEvents and consumed by the replay thread.
+// seekPermille is an absolute position (0 = start, 1000 = end) or -1 for none;
+// seekTenths is a relative jump in tenths of the trace.
+std::atomic<int> seekPermille{-1};
+std::atomic<int> seekTenths{0};
+
+// Sort threads still running during an export; the export loop stops once
+// this drops to zero.
+std::atomic<int> activeSorts{0};
+
+// Serializes console output from the sort threads.
+std::mutex console_mtx;
+
+bool buildGlyphAtlas(SDL_Renderer* renderer, GlyphAtlas& atlas) {
+    std::string glyphs;
+    for (char c = ATLAS_FIRST; c <= ATLAS_LAST; ++c) glyphs += c;
+
+    SDL_Color color = {255, 255, 255};  // White color for text
+    SDL_Surface* strip = TTF_RenderText_Solid(font, glyphs.c_str(), color);
+    if (!strip) {
+        std::cerr << "Failed to create surface for glyph atlas! TTF_Error: " << TTF_GetError() << std::endl;
+        return false;
+    }
+
+    // Glyph boundaries come from the advance of each prefix, so the sub-rects
+    // line up with how TTF laid the strip out.
+    int prevX = 0;
+    for (size_t g = 0; g < glyphs.size(); ++g) {
+        int w = 0, h = 0;
+        TTF_SizeText(font, glyphs.substr(0, g + 1).c_str(), &w, &h);
+        atlas.glyphs[g] = {prevX, 0, w - prevX, strip->h};
+        prevX = w;
+    }
+
+    atlas.texture = SDL_CreateTextureFromSurface(renderer, strip);
+    SDL_FreeSurface(strip);
+    if (!atlas.texture) {
+        std::cerr << "Failed to create glyph atlas texture! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void destroyGlyphAtlas(GlyphAtlas& atlas) {
+    if (atlas.texture) SDL_DestroyTexture(atlas.texture);
+    atlas = GlyphAtlas{};
+}
 
-std::mutex mtx;
-std::condition_variable cv;
-std::mutex render_mtx;
+// Fills `tiles` for the chosen algorithms and returns the number of tile rows,
+// or 0 if an option is invalid.
+int layoutTiles(int options[], int count) {
+    tiles.clear();
+    int columns = count > MAX_SINGLE_COLUMN_TILES ? 2 : 1;
+    int tileWidth = WINDOW_WIDTH / columns;
+    for (int k = 0; k < count; ++k) {
+        int opt = options[k];
+        if (opt < 1 || opt > SORT_ALGORITHM_COUNT) {
+            std::cerr << "Invalid option!" << std::endl;
+            return 0;
+        }
+        tiles.push_back({opt - 1, {(k % columns) * tileWidth, (k / columns) * TILE_HEIGHT, tileWidth, TILE_HEIGHT}});
+    }
+    return (count + columns - 1) / columns;
+}
 
 bool init(int options[], int count) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -62,54 +239,115 @@ bool init(int options[], int count) {
         return false;
     }
 
+    SDL_DisplayMode mode;
+    if (SDL_GetCurrentDisplayMode(0, &mode) == 0 && mode.refresh_rate > 0) {
+        displayRefreshRate = mode.refresh_rate;
+    }
+
     font = TTF_OpenFont("arial.ttf", 13);
     if (!font) {
         std::cerr << "Failed to load font! TTF_Error: " << TTF_GetError() << std::endl;
         return false;
     }
 
-    string titles[] = {"Selection Sort Visualizer", "Insertion Sort Visualizer", "Bubble Sort Visualizer", "Merge Sort Visualizer", "Quick Sort Visualizer", "Heap Sort Visualizer"};
+    int rows = layoutTiles(options, count);
+    if (rows == 0) return false;
 
-    for (int k = 0; k < count; ++k) {
-        int opt = options[k];
-        if (opt < 1 || opt > 6) {
-            std::cerr << "Invalid option!" << std::endl;
-            return false;
-        }
-
-        int i = opt - 1;
-        int posX = 20;
-        int posY = 40 + (i % 3) * (WINDOW_HEIGHT + 30);
-
-        windows[i] = SDL_CreateWindow(titles[i].c_str(), posX, posY, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
-        if (!windows[i]) {
-            std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-            SDL_Quit();
-            return false;
-        }
-        renderers[i] = SDL_CreateRenderer(windows[i], -1, SDL_RENDERER_ACCELERATED);
-        if (!renderers[i]) {
-            std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-            SDL_DestroyWindow(windows[i]);
-            SDL_Quit();
-            return false;
-        }
+    std::string title = count == 1 ? std::string(sortAlgorithmName(options[0])) + " Visualizer" : "Sorting Visualizer";
+    window = SDL_CreateWindow(title.c_str(), 20, 40, WINDOW_WIDTH, rows * TILE_HEIGHT, SDL_WINDOW_SHOWN);
+    if (!window) {
+        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        SDL_Quit();
+        return false;
+    }
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if (!renderer) {
+        // No GPU (headless boxes, remote sessions): the pixel backend still
+        // runs well on the software renderer.
+        std::cerr << "No accelerated renderer, falling back to software. SDL_Error: " << SDL_GetError() << std::endl;
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    }
+    if (!renderer) {
+        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        SDL_DestroyWindow(window);
+        window = nullptr;
+        SDL_Quit();
+        return false;
+    }
+    if (!buildGlyphAtlas(renderer, atlas)) {
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        renderer = nullptr;
+        window = nullptr;
+        SDL_Quit();
+        return false;
     }
     return true;
 }
 
 void close() {
-    for (int i = 0; i < 6; ++i) {
-        if (renderers[i]) SDL_DestroyRenderer(renderers[i]);
-        if (windows[i]) SDL_DestroyWindow(windows[i]);
+    destroyGlyphAtlas(atlas);
+    for (auto& canvas : tileCanvases) {
+        if (canvas.texture) SDL_DestroyTexture(canvas.texture);
+        canvas = TileCanvas{};
     }
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (window) SDL_DestroyWindow(window);
+    if (offscreenSurface) SDL_FreeSurface(offscreenSurface);
+    renderer = nullptr;
+    window = nullptr;
+    offscreenSurface = nullptr;
+    tiles.clear();
     TTF_CloseFont(font);
     font = nullptr;
     TTF_Quit();
     SDL_Quit();
 }
 
-void renderText(SDL_Renderer* renderer, const std::string& text, int x, int y) {
+// Export counterpart of init: no window, SDL's dummy video driver and a
+// software renderer drawing into a memory surface the size the window would
+// have been. displayRefreshRate becomes the export frame rate.
+bool initOffscreen(int options[], int count, int fps) {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    if (TTF_Init() < 0) {
+        std::cerr << "SDL_ttf could not initialize! TTF_Error: " << TTF_GetError() << std::endl;
+        return false;
+    }
+    displayRefreshRate = fps;
+
+    font = TTF_OpenFont("arial.ttf", 13);
+    if (!font) {
+        std::cerr << "Failed to load font! TTF_Error: " << TTF_GetError() << std::endl;
+        return false;
+    }
+
+    int rows = layoutTiles(options, count);
+    if (rows == 0) {
+        close();
+        return false;
+    }
+
+    offscreenSurface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, rows * TILE_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!offscreenSurface) {
+        std::cerr << "Offscreen surface could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        close();
+        return false;
+    }
+    renderer = SDL_CreateSoftwareRenderer(offscreenSurface);
+    if (!renderer || !buildGlyphAtlas(renderer, atlas)) {
+        std::cerr << "Offscreen renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void renderTextUncached(SDL_Renderer* renderer, const std::string& text, int x, int y) {
     SDL_Color color = {255, 255, 255};  // White color for text
     SDL_Surface* surfaceMessage = TTF_RenderText_Solid(font, text.c_str(), color);
     if (!surfaceMessage) {
@@ -131,68 +369,472 @@ void renderText(SDL_Renderer* renderer, const std::string& text, int x, int y) {
     SDL_DestroyTexture(message);
 }
 
-void renderSort(SDL_Renderer* renderer, const std::vector<int>& arr, size_t currentIndex, size_t secondIndex, const std::string& mode) {
-    std::lock_guard<std::mutex> lock(render_mtx);
-    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
-    SDL_RenderClear(renderer);
+// Width in pixels renderText would give `text`.
+int textWidth(const std::string& text) {
+    bool inAtlas = std::all_of(text.begin(), text.end(), [](char c) { return c >= ATLAS_FIRST && c <= ATLAS_LAST; });
+    if (!atlas.texture || !inAtlas) {
+        int w = 0;
+        return font && TTF_SizeText(font, text.c_str(), &w, nullptr) == 0 ? w : 0;
+    }
+    int w = 0;
+    for (char c : text) w += atlas.glyphs[c - ATLAS_FIRST].w;
+    return w;
+}
 
-    int numElements = arr.size();
-    int barWidth = (WINDOW_WIDTH - (BAR_GAP * (numElements - 1))) / numElements;
+void renderText(SDL_Renderer* renderer, const std::string& text, int x, int y) {
+    bool inAtlas = std::all_of(text.begin(), text.end(), [](char c) { return c >= ATLAS_FIRST && c <= ATLAS_LAST; });
+    if (!atlas.texture || !inAtlas) {
+        renderTextUncached(renderer, text, x, y);
+        return;
+    }
 
-    for (size_t i = 0; i < arr.size(); ++i) {
-        int height = (arr[i] * (WINDOW_HEIGHT - 40)) / 100;
-        SDL_Rect bar = {static_cast<int>(i * (barWidth + BAR_GAP)), WINDOW_HEIGHT - height - 30, barWidth, height};
+    for (char c : text) {
+        const SDL_Rect& glyph = atlas.glyphs[c - ATLAS_FIRST];
+        SDL_Rect dst = {x, y, glyph.w, glyph.h};
+        SDL_RenderCopy(renderer, atlas.texture, &glyph, &dst);
+        x += glyph.w;
+    }
+}
 
-        if (mode == "update") {
-            SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0x00, 0xFF);
-        } else if (mode == "selection") {
-            if (i == currentIndex) {
-                SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
-            } else if (i == secondIndex) {
-                SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0xFF, 0xFF);
-            } else {
-                SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0x00, 0xFF);
-            }
-        } else if (mode == "insertion") {
-            if (i < currentIndex) {
-                SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0x00, 0xFF);
-            } else if (i == secondIndex) {
-                SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0xFF, 0xFF);
-            } else {
-                SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
+// Highlight policies map a bar to its colour bucket. paintTile is instantiated
+// per policy, so each algorithm's colouring rule is fixed at compile time and a
+// new algorithm only needs its own policy struct to change how it is drawn.
+// collectRepaint always repaints the old and new highlighted bars; a policy
+// whose colouring reaches further hides HighlightPolicy::addRepaint with its
+// own, which adds the other bars that change colour when the highlight moves
+// from `before` to `after`, or returns false if the whole tile must repaint.
+struct Highlighted {
+    size_t current;
+    size_t second;
+};
+
+struct HighlightPolicy {
+    static bool addRepaint(std::vector<IndexRange>&, size_t, Highlighted, Highlighted) { return true; }
+};
+
+struct UpdateHighlight : HighlightPolicy {
+    static BarBucket bucket(size_t, size_t, size_t) { return BAR_NORMAL; }
+};
+
+struct PairHighlight : HighlightPolicy {
+    static BarBucket bucket(size_t i, size_t currentIndex, size_t secondIndex) {
+        return i == currentIndex ? BAR_CURRENT : (i == secondIndex ? BAR_SECOND : BAR_NORMAL);
+    }
+};
+
+// currentIndex is the slot being examined, secondIndex the end of the sorted
+// prefix. Moving the end of the prefix recolours everything it passes over.
+struct InsertionHighlight : HighlightPolicy {
+    static bool addRepaint(std::vector<IndexRange>& repaint, size_t n, Highlighted before, Highlighted after) {
+        size_t from = std::min(before.second, n);
+        size_t to = std::min(after.second, n);
+        repaint.push_back({std::min(from, to), std::max(from, to)});
+        return true;
+    }
+    static BarBucket bucket(size_t i, size_t currentIndex, size_t secondIndex) {
+        return i < secondIndex ? BAR_NORMAL : (i == currentIndex ? BAR_SECOND : BAR_CURRENT);
+    }
+};
+
+// Radix sorts report each write as (slot, start of its bucket) and Powersort
+// each step as (slot, start of its run): the bucket or run so far is drawn as
+// a band ending in the slot just touched.
+struct BandHighlight : HighlightPolicy {
+    static bool addRepaint(std::vector<IndexRange>& repaint, size_t n, Highlighted before, Highlighted after) {
+        auto band = [n](Highlighted h) {
+            return h.second < n && h.current < n && h.second <= h.current ? IndexRange{h.second, h.current + 1} : IndexRange{0, 0};
+        };
+        IndexRange from = band(before);
+        IndexRange to = band(after);
+        // A band that keeps its start only changed between its old and new end.
+        if (from.begin == to.begin && from.end > 0 && to.end > 0) {
+            repaint.push_back({std::min(from.end, to.end) - 1, std::max(from.end, to.end)});
+        } else {
+            repaint.push_back(from);
+            repaint.push_back(to);
+        }
+        return true;
+    }
+    static BarBucket bucket(size_t i, size_t currentIndex, size_t secondIndex) {
+        return i == currentIndex ? BAR_CURRENT : (i >= secondIndex && i < currentIndex ? BAR_SECOND : BAR_NORMAL);
+    }
+};
+
+// Sorting networks compare i with i ^ mask throughout a stage, so the stage
+// is read off the current pair. The upper partner of every comparator in it
+// is drawn darker, which shows the stage's parallel compare-exchanges as
+// stripes as wide as its highest mask bit; a new stage recolours every bar.
+struct NetworkHighlight : HighlightPolicy {
+    static size_t stage(size_t currentIndex, size_t secondIndex) { return std::bit_floor(currentIndex ^ secondIndex); }
+    static bool addRepaint(std::vector<IndexRange>&, size_t, Highlighted before, Highlighted after) {
+        return stage(before.current, before.second) == stage(after.current, after.second);
+    }
+    static BarBucket bucket(size_t i, size_t currentIndex, size_t secondIndex) {
+        if (i == currentIndex) return BAR_CURRENT;
+        if (i == secondIndex) return BAR_SECOND;
+        return i & stage(currentIndex, secondIndex) ? BAR_STAGE : BAR_NORMAL;
+    }
+};
+
+// Heap sorts report each step as (node, root of the sift): the path the sift
+// has taken down the D-ary heap is drawn from the root to the current node,
+// so both the old and the new path repaint.
+template <int D>
+struct HeapHighlight : HighlightPolicy {
+    static bool addRepaint(std::vector<IndexRange>& repaint, size_t n, Highlighted before, Highlighted after) {
+        for (Highlighted h : {before, after}) {
+            if (h.current >= n || h.second >= n) continue;
+            for (size_t node = h.current; node >= h.second; node = (node - 1) / D) {
+                repaint.push_back({node, node + 1});
+                if (node == h.second || node == 0) break;
             }
+        }
+        return true;
+    }
+    static BarBucket bucket(size_t i, size_t currentIndex, size_t secondIndex) {
+        if (i == currentIndex) return BAR_CURRENT;
+        if (i > currentIndex || i < secondIndex) return BAR_NORMAL;
+        size_t node = currentIndex;
+        while (node > i) node = (node - 1) / D;
+        return node == i ? BAR_SECOND : BAR_NORMAL;
+    }
+};
+
+int barWidthFor(int tileWidth, size_t numElements) {
+    return (tileWidth - (BAR_GAP * (static_cast<int>(numElements) - 1))) / static_cast<int>(numElements);
+}
+
+// Values the bars are scaled to: `lo` draws no bar and `hi` one as tall as the
+// tile allows. Values outside the range are clamped to it.
+struct ValueRange {
+    int lo = 0;
+    int hi = 99;
+};
+
+// The range of the values in `arr`, which every step of a sort preserves.
+ValueRange valueRangeOf(const std::vector<int>& arr) {
+    if (arr.empty()) return {};
+    auto [lo, hi] = std::minmax_element(arr.begin(), arr.end());
+    return {*lo, *hi};
+}
+
+int barHeightFor(int value, ValueRange values, int tileHeight) {
+    int64_t span = static_cast<int64_t>(values.hi) - values.lo;
+    int64_t offset = std::clamp<int64_t>(static_cast<int64_t>(value) - values.lo, 0, std::max<int64_t>(span, 0));
+    return static_cast<int>(offset * std::max(tileHeight - 40, 0) / (std::max<int64_t>(span, 0) + 1));
+}
+
+bool useColumnMode(int tileWidth, size_t numElements) {
+    return numElements > 0 && barWidthFor(tileWidth, numElements) < MIN_BAR_WIDTH;
+}
+
+std::string formatCounters(const OpCounters& counters) {
+    return "cmp " + std::to_string(counters.comparisons) + "  swp " + std::to_string(counters.swaps) +
+           "  wr " + std::to_string(counters.writes) + "  aux " + std::to_string(counters.auxBytes) + "B/" +
+           std::to_string(counters.allocations) + " allocs  depth " + std::to_string(counters.maxDepth);
+}
+
+void renderHud(SDL_Renderer* renderer, const Tile& tile, const OpCounters& counters) {
+    std::string hud = std::string(sortAlgorithmName(tile.slot + 1)) + "  |  " + formatCounters(counters);
+    renderText(renderer, hud, 5, tile.rect.h - 22);
+}
+
+Uint32 packColor(const SDL_Color& c, int shift = 0) {
+    return 0xFF000000u | static_cast<Uint32>(c.r >> shift) << 16 | static_cast<Uint32>(c.g >> shift) << 8 | static_cast<Uint32>(c.b >> shift);
+}
+
+// Latest published state of one visualization. The sort thread publishes a
+// frame at most once per display frame through a triple buffer, so neither it
+// nor the render loop ever blocks on the other or on another tile. Arrays that
+// fit the tile are published whole; larger ones only as their column envelopes.
+// `dirty` covers every index written since the previous frame (sequence - 1).
+struct ViewFrame {
+    std::vector<int> arr;
+    std::vector<ColumnSpan> columns;
+    size_t elements = 0;
+    size_t currentIndex = -1;
+    size_t secondIndex = -1;
+    IndexRange dirty = {0, 0};
+    ValueRange values;
+    uint64_t sequence = 0;
+    OpCounters counters;
+};
+
+// Forces every tile to be repainted whole on its next frame.
+void invalidateCanvases() {
+    for (auto& canvas : tileCanvases) canvas.sequence = 0;
+}
+
+// (Re)creates a canvas texture when the mode or size changes. Returns false
+// if the renderer cannot provide one.
+bool prepareCanvas(SDL_Renderer* renderer, TileCanvas& canvas, int access, int width, int height) {
+    if (canvas.access != access || canvas.width != width || canvas.height != height) {
+        if (canvas.texture) SDL_DestroyTexture(canvas.texture);
+        canvas.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, access, width, height);
+        canvas.access = access;
+        canvas.width = width;
+        canvas.height = height;
+        canvas.sequence = 0;
+        if (!canvas.texture) {
+            std::cerr << "Failed to create tile texture! SDL_Error: " << SDL_GetError() << std::endl;
+        }
+    }
+    return canvas.texture != nullptr;
+}
+
+// Collects the index ranges that differ between the canvas and `frame`: the
+// elements written in between, the old and new highlight positions and
+// whatever else the policy says changed colour.
+template <typename Highlight>
+void collectRepaint(TileCanvas& canvas, const ViewFrame& frame, bool full) {
+    size_t n = frame.elements;
+    canvas.repaint.clear();
+    if (!full) {
+        if (frame.dirty.begin < frame.dirty.end) canvas.repaint.push_back(frame.dirty);
+        for (size_t i : {canvas.currentIndex, canvas.secondIndex, frame.currentIndex, frame.secondIndex}) {
+            if (i < n) canvas.repaint.push_back({i, i + 1});
+        }
+        full = !Highlight::addRepaint(canvas.repaint, n, {canvas.currentIndex, canvas.secondIndex}, {frame.currentIndex, frame.secondIndex});
+    }
+    if (full) {
+        canvas.repaint.clear();
+        canvas.repaint.push_back({0, n});
+    }
+}
+
+// Draws the value labels of the bars in `range`, if the bars are wide enough
+// to carry them. A label wider than its bar's strip is left out, since only
+// the strip is cleared when the bar is repainted.
+void renderBarLabels(SDL_Renderer* renderer, const std::vector<int>& arr, IndexRange range, ValueRange values, int tileWidth, int tileHeight) {
+    int barWidth = barWidthFor(tileWidth, arr.size());
+    if (barWidth < MIN_LABELLED_BAR_WIDTH) return;
+    int stride = barWidth + BAR_GAP;
+    for (size_t i = range.begin; i < std::min(range.end, arr.size()); ++i) {
+        std::string label = std::to_string(arr[i]);
+        if (textWidth(label) > stride) continue;
+        int textYPos = std::max(tileHeight - barHeightFor(arr[i], values, tileHeight) - 30 - 20, 0);
+        renderText(renderer, label, static_cast<int>(i) * stride, textYPos);
+    }
+}
+
+// Repaints the bars in canvas.repaint. Each bar's strip (bar, gap and label)
+// is cleared first so nothing outside the repainted bars is touched. Without
+// a texture the bars go straight into the tile and `full` must be set.
+template <typename Highlight>
+void paintBars(SDL_Renderer* renderer, const Tile& tile, TileCanvas& canvas, const ViewFrame& frame, bool toTexture, bool full) {
+    const std::vector<int>& arr = frame.arr;
+    int tileHeight = tile.rect.h;
+    int barWidth = barWidthFor(tile.rect.w, arr.size());
+    int stride = barWidth + BAR_GAP;
+
+    BarBatch& batch = barBatches[tile.slot];
+    for (auto& rects : batch.rects) rects.clear();
+    canvas.strips.clear();
+    for (const IndexRange& range : canvas.repaint) {
+        for (size_t i = range.begin; i < std::min(range.end, arr.size()); ++i) {
+            int x = static_cast<int>(i) * stride;
+            int height = barHeightFor(arr[i], frame.values, tileHeight);
+            canvas.strips.push_back({x, 0, stride, tileHeight});
+            batch.rects[Highlight::bucket(i, frame.currentIndex, frame.secondIndex)].push_back({x, tileHeight - height - 30, barWidth, height});
+        }
+    }
+
+    if (toTexture) {
+        SDL_SetRenderTarget(renderer, canvas.texture);
+        SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
+        if (full) {
+            SDL_RenderClear(renderer);
         } else {
-            if (i == currentIndex) {
-                SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
-            } else if (i == secondIndex) {
-                SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0xFF, 0xFF);
-            } else {
-                SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0x00, 0xFF);
+            SDL_RenderFillRects(renderer, canvas.strips.data(), static_cast<int>(canvas.strips.size()));
+        }
+    } else {
+        SDL_RenderSetViewport(renderer, &tile.rect);
+    }
+
+    for (int b = 0; b < BAR_BUCKETS; ++b) {
+        if (batch.rects[b].empty()) continue;
+        const SDL_Color& c = BUCKET_COLORS[b];
+        SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+        SDL_RenderFillRects(renderer, batch.rects[b].data(), static_cast<int>(batch.rects[b].size()));
+    }
+
+    for (const IndexRange& range : canvas.repaint) {
+        renderBarLabels(renderer, arr, range, frame.values, tile.rect.w, tileHeight);
+    }
+
+    if (toTexture) SDL_SetRenderTarget(renderer, nullptr);
+}
+
+// Pixel-backend counterpart of paintBars: the strips of the bars in
+// canvas.repaint are rasterized straight into the streaming texture, one
+// locked rect per range and one background span plus one span per bar on each
+// row. Labels cannot live in the pixels; paintTile draws them on top.
+template <typename Highlight>
+void rasterizeBars(const Tile& tile, TileCanvas& canvas, const ViewFrame& frame) {
+    const std::vector<int>& arr = frame.arr;
+    int width = canvas.width;
+    int height = canvas.height;
+    int barWidth = barWidthFor(tile.rect.w, arr.size());
+    int stride = barWidth + BAR_GAP;
+    int baseline = height - 30;
+
+    const Uint32 background = 0xFF000000u;
+    for (const IndexRange& range : canvas.repaint) {
+        size_t end = std::min(range.end, arr.size());
+        if (range.begin >= end) continue;
+        int x0 = static_cast<int>(range.begin) * stride;
+        int x1 = std::min(static_cast<int>(end) * stride, width);
+        if (x0 >= x1) continue;
+
+        size_t count = end - range.begin;
+        canvas.solidTop.resize(count);
+        canvas.solidColor.resize(count);
+        for (size_t i = range.begin; i < end; ++i) {
+            canvas.solidTop[i - range.begin] = baseline - barHeightFor(arr[i], frame.values, tile.rect.h);
+            canvas.solidColor[i - range.begin] = packColor(BUCKET_COLORS[Highlight::bucket(i, frame.currentIndex, frame.secondIndex)]);
+        }
+
+        SDL_Rect rect = {x0, 0, x1 - x0, height};
+        void* pixels;
+        int pitch;
+        if (SDL_LockTexture(canvas.texture, &rect, &pixels, &pitch) != 0) continue;
+        for (int y = 0; y < height; ++y) {
+            Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(pixels) + static_cast<size_t>(y) * pitch);
+            fillSpan(row, x1 - x0, background);
+            if (y >= baseline) continue;
+            for (size_t k = 0; k < count; ++k) {
+                if (y < canvas.solidTop[k]) continue;
+                int x = static_cast<int>(k) * stride;
+                fillSpan(row + x, std::min(barWidth, x1 - x0 - x), canvas.solidColor[k]);
+            }
+        }
+        SDL_UnlockTexture(canvas.texture);
+    }
+}
+
+// Column-mode counterpart of paintBars: each pixel column is filled solid up
+// to the smallest value it covers and half-bright up to the largest, so the
+// spread inside a column stays visible. A column takes the colour of the
+// highlighted index it contains, if any. Only the columns covering
+// canvas.repaint are locked and rewritten.
+template <typename Highlight>
+void paintColumns(const Tile& tile, TileCanvas& canvas, const ViewFrame& frame) {
+    const std::vector<ColumnSpan>& columns = frame.columns;
+    int width = canvas.width;
+    int height = canvas.height;
+    size_t n = frame.elements;
+    canvas.solidTop.resize(width);
+    canvas.envelopeTop.resize(width);
+    canvas.solidColor.resize(width);
+    canvas.envelopeColor.resize(width);
+
+    const Uint32 background = 0xFF000000u;
+    for (const IndexRange& range : canvas.repaint) {
+        IndexRange cols = columnsCovering(range, n, width);
+        if (cols.begin >= cols.end) continue;
+
+        for (size_t c = cols.begin; c < cols.end; ++c) {
+            size_t start = columnStart(c, n, width);
+            size_t end = std::max(columnStart(c + 1, n, width), start + 1);
+            size_t i = frame.currentIndex >= start && frame.currentIndex < end ? frame.currentIndex
+                     : (frame.secondIndex >= start && frame.secondIndex < end ? frame.secondIndex : start);
+            const SDL_Color& color = BUCKET_COLORS[Highlight::bucket(i, frame.currentIndex, frame.secondIndex)];
+            canvas.solidTop[c] = height - barHeightFor(columns[c].lo, frame.values, tile.rect.h);
+            canvas.envelopeTop[c] = height - barHeightFor(columns[c].hi, frame.values, tile.rect.h);
+            canvas.solidColor[c] = packColor(color);
+            canvas.envelopeColor[c] = packColor(color, 1);
+        }
+
+        SDL_Rect rect = {static_cast<int>(cols.begin), 0, static_cast<int>(cols.end - cols.begin), height};
+        void* pixels;
+        int pitch;
+        if (SDL_LockTexture(canvas.texture, &rect, &pixels, &pitch) != 0) continue;
+        for (int y = 0; y < height; ++y) {
+            Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(pixels) + static_cast<size_t>(y) * pitch) - cols.begin;
+            for (size_t c = cols.begin; c < cols.end; ++c) {
+                row[c] = y >= canvas.solidTop[c] ? canvas.solidColor[c] : (y >= canvas.envelopeTop[c] ? canvas.envelopeColor[c] : background);
             }
         }
+        SDL_UnlockTexture(canvas.texture);
+    }
+}
 
-        SDL_RenderFillRect(renderer, &bar);
+// Brings a tile's canvas up to date with `frame` and copies it into the tile.
+// A frame that directly follows the one on the canvas only repaints what
+// changed; a skipped frame, a new canvas or `full` repaints everything.
+template <typename Highlight>
+void paintTile(SDL_Renderer* renderer, const Tile& tile, const ViewFrame& frame, bool full = false) {
+    TileCanvas& canvas = tileCanvases[tile.slot];
+    bool columnMode = !frame.columns.empty();
+    bool pixelBars = !columnMode && renderBackend == BACKEND_PIXELS;
+    int width = columnMode ? static_cast<int>(frame.columns.size()) : tile.rect.w;
+    int height = columnMode ? tile.rect.h - 30 : tile.rect.h;
+    int access = columnMode || pixelBars ? SDL_TEXTUREACCESS_STREAMING : SDL_TEXTUREACCESS_TARGET;
+    bool hasTexture = prepareCanvas(renderer, canvas, access, width, height);
+    if (columnMode && !hasTexture) return;
+    if (!columnMode && frame.arr.empty()) return;
+    // Without a streaming texture the pixel backend draws like the rects one.
+    pixelBars = pixelBars && hasTexture;
+
+    if (full || !hasTexture || frame.sequence != canvas.sequence) {
+        full = full || !hasTexture || canvas.sequence == 0 || frame.sequence != canvas.sequence + 1;
+        collectRepaint<Highlight>(canvas, frame, full);
+        if (columnMode) {
+            paintColumns<Highlight>(tile, canvas, frame);
+        } else if (pixelBars) {
+            rasterizeBars<Highlight>(tile, canvas, frame);
+        } else {
+            paintBars<Highlight>(renderer, tile, canvas, frame, hasTexture, full);
+        }
+        canvas.sequence = frame.sequence;
+        canvas.currentIndex = frame.currentIndex;
+        canvas.secondIndex = frame.secondIndex;
+    }
 
-        int textYPos = std::max(WINDOW_HEIGHT - height - 30 - 20, 0);
-        renderText(renderer, std::to_string(arr[i]), static_cast<int>(i * (barWidth + BAR_GAP)), textYPos);
+    SDL_RenderSetViewport(renderer, &tile.rect);
+    if (hasTexture) {
+        SDL_Rect dst = {0, 0, width, height};
+        SDL_RenderCopy(renderer, canvas.texture, nullptr, &dst);
     }
+    if (pixelBars) renderBarLabels(renderer, frame.arr, {0, frame.arr.size()}, frame.values, tile.rect.w, tile.rect.h);
+}
 
-    SDL_RenderPresent(renderer);
+using DrawFn = void (*)(SDL_Renderer*, const Tile&, const ViewFrame&);
+
+template <typename Highlight>
+void drawFrame(SDL_Renderer* renderer, const Tile& tile, const ViewFrame& frame) {
+    paintTile<Highlight>(renderer, tile, frame);
+    renderHud(renderer, tile, frame.counters);
 }
 
+struct SharedView {
+    TripleBuffer<ViewFrame> frames;
+    std::atomic<DrawFn> draw{nullptr};
+};
+
+SharedView views[SORT_ALGORITHM_COUNT];
+
+void requestQuit() {
+    quit = true;
+    // Wake any sort thread parked in waitForResume so it sees quit.
+    paused = false;
+    paused.notify_all();
+}
+
+// Must only be called from the main thread.
 void handleEvents() {
     SDL_Event e;
     while (SDL_PollEvent(&e) != 0) {
         if (e.type == SDL_QUIT) {
-            std::lock_guard<std::mutex> lock(mtx);
-            quit = true;
-            cv.notify_all();
+            requestQuit();
+        }
+        else if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET) {
+            // Render-target contents are gone; repaint every tile from scratch.
+            invalidateCanvases();
         }
         else if (e.type == SDL_KEYDOWN) {
-            std::lock_guard<std::mutex> lock(mtx);
             if (e.key.keysym.sym == SDLK_ESCAPE) {
-                quit = true;
-                cv.notify_all();
+                requestQuit();
             }
             else if (e.key.keysym.sym == SDLK_p) {
                 paused = !paused;
@@ -200,29 +842,59 @@ void handleEvents() {
                     clearScreen();
                     std::cout << RED << "Paused. Press 'P' to resume." << RESET << "\n";
                 } else {
-                    cv.notify_all();
+                    paused.notify_all();
                 }
             }
             else if (e.key.keysym.sym == SDLK_RIGHT) {
-                if (delay > 10) {
+                int rate = stepsPerSecond;
+                if (rate < MAX_STEPS_PER_SECOND) {
                     clearScreen();
-                    delay -= 10;
-                    std::cout << GREEN << "Speed increased. Delay: " << delay << "ms" << RESET << "\n";
+                    stepsPerSecond = std::min(rate * 2, MAX_STEPS_PER_SECOND);
+                    std::cout << GREEN << "Speed increased. " << stepsPerSecond << " steps/s" << RESET << "\n";
                 }
             }
             else if (e.key.keysym.sym == SDLK_LEFT) {
-                clearScreen();
-                delay += 10;
-                std::cout << YELLOW << "Speed decreased. Delay: " << delay << "ms" << RESET << "\n";
+                int rate = stepsPerSecond;
+                if (rate > 1) {
+                    clearScreen();
+                    stepsPerSecond = rate / 2;
+                    std::cout << YELLOW << "Speed decreased. " << stepsPerSecond << " steps/s" << RESET << "\n";
+                }
+            }
+            else if (e.key.keysym.sym == SDLK_HOME) {
+                seekPermille = 0;
+            }
+            else if (e.key.keysym.sym == SDLK_END) {
+                seekPermille = 1000;
+            }
+            else if (e.key.keysym.sym == SDLK_PAGEUP) {
+                ++seekTenths;
+            }
+            else if (e.key.keysym.sym == SDLK_PAGEDOWN) {
+                --seekTenths;
             }
             else if (e.key.keysym.sym == SDLK_0) {
-                std::vector<int> newArr(80);
-                for (int i = 0; i < 80; ++i) {
-                    newArr[i] = std::rand() % 100;
-                }
-                for (int i = 0; i < 6; ++i) {
-                    renderSort(renderers[i], newArr, 0, 0, "update");
+                std::vector<int> newArr = makeInput(threadRng()());
+                SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
+                SDL_RenderClear(renderer);
+                ViewFrame frame;
+                frame.elements = newArr.size();
+                frame.values = {inputSpec.minValue, inputSpec.maxValue};
+                frame.currentIndex = frame.secondIndex = 0;
+                for (const Tile& tile : tiles) {
+                    if (useColumnMode(tile.rect.w, newArr.size())) {
+                        reduceColumns(newArr, tile.rect.w, frame.columns);
+                        frame.arr.clear();
+                    } else {
+                        frame.arr = newArr;
+                        frame.columns.clear();
+                    }
+                    paintTile<UpdateHighlight>(renderer, tile, frame, true);
                 }
+                // The canvases now show this array, not the sorts' last frames.
+                invalidateCanvases();
+                SDL_RenderSetViewport(renderer, nullptr);
+                SDL_RenderPresent(renderer);
                 clearScreen();
                 std::cout << BLUE << "New array generated and visualized." << RESET << "\n";
             }
@@ -230,231 +902,345 @@ void handleEvents() {
     }
 }
 
+// Parks a sort thread while paused; the main thread flips `paused` and notifies.
 void waitForResume() {
-    std::unique_lock<std::mutex> lock(mtx);
     while (paused && !quit) {
-        cv.wait(lock);
-        handleEvents(); 
+        paused.wait(true);
     }
-    if (quit) {
-        lock.unlock();
+}
+
+// Only called once the sort threads have been joined.
+void resetViews() {
+    for (auto& view : views) {
+        view.frames.reset();
+        view.draw = nullptr;
     }
 }
 
-void selectionSort(std::vector<int>& arr, SDL_Renderer* renderer) {
-    for (size_t i = 0; i < arr.size() - 1; ++i) {
-        size_t minIndex = i;
-        for (size_t j = i + 1; j < arr.size(); ++j) {
-            handleEvents();
-            {
-                std::lock_guard<std::mutex> lock(mtx);
-                if (quit) return;
-            }
-            waitForResume();
-            if (arr[j] < arr[minIndex]) {
-                minIndex = j;
-            }
-            renderSort(renderer, arr, j, minIndex, "selection");
-            SDL_Delay(delay);
-        }
-        std::swap(arr[i], arr[minIndex]);
-        renderSort(renderer, arr, i, minIndex, "selection");
-        SDL_Delay(delay);
+// Draws every tile and presents the whole window once.
+void renderViews() {
+    SDL_RenderSetViewport(renderer, nullptr);
+    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
+    SDL_RenderClear(renderer);
+
+    for (const Tile& tile : tiles) {
+        SharedView& view = views[tile.slot];
+        DrawFn draw = view.draw.load(std::memory_order_acquire);
+        if (!draw) continue;
+        view.frames.consume();
+        draw(renderer, tile, view.frames.readBuffer());
     }
+
+    SDL_RenderSetViewport(renderer, nullptr);
+    SDL_SetRenderDrawColor(renderer, 0x40, 0x40, 0x40, 0xFF);
+    for (const Tile& tile : tiles) {
+        if (tile.rect.y > 0) SDL_RenderDrawLine(renderer, tile.rect.x, tile.rect.y, tile.rect.x + tile.rect.w - 1, tile.rect.y);
+        if (tile.rect.x > 0) SDL_RenderDrawLine(renderer, tile.rect.x, tile.rect.y, tile.rect.x, tile.rect.y + tile.rect.h - 1);
+    }
+    SDL_RenderPresent(renderer);
 }
 
-void insertionSort(std::vector<int>& arr, SDL_Renderer* renderer) {
-    for (size_t i = 1; i < arr.size(); ++i) {
-        int key = arr[i];
-        size_t j = i - 1;
+// Main-thread loop while visualizations are running: pump events and redraw
+// the window once per display frame until quit is set. Vsync paces the loop
+// where the driver supports it; the delay covers the case where it does not.
+void runRenderLoop() {
+    const Uint32 frameMs = std::max(1, 1000 / displayRefreshRate);
+    while (!quit) {
+        Uint32 frameStart = SDL_GetTicks();
+        handleEvents();
+        renderViews();
+        Uint32 spent = SDL_GetTicks() - frameStart;
+        if (spent < frameMs) SDL_Delay(frameMs - spent);
+    }
+}
 
-        while (j < arr.size() && arr[j] > key) {
-            handleEvents();
-            {
-                std::lock_guard<std::mutex> lock(mtx);
-                if (quit) return;
-            }
-            waitForResume();
-            arr[j + 1] = arr[j];
-            renderSort(renderer, arr, i, j + 1, "insertion");
-            j--;
-            SDL_Delay(delay);
-        }
-        arr[j + 1] = key;
-        renderSort(renderer, arr, i, j + 1, "insertion");
-        SDL_Delay(delay);
+// Export counterpart of runRenderLoop: draws a frame every 1/fps seconds,
+// hands it to the exporter and stops once every sort has finished (after one
+// last frame showing the final state) or quit is set. The sorts stay paced by
+// stepsPerSecond, so the video's frame rate and the step rate are independent.
+// A full export queue only delays this loop, never the sort threads.
+void runExportLoop(FrameExporter& exporter, int fps) {
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t frame = 1; !quit; ++frame) {
+        bool finished = activeSorts.load() == 0;
+        handleEvents();
+        renderViews();
+        std::vector<uint32_t>& pixels = exporter.acquire();
+        SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, pixels.data(), exporter.width() * 4);
+        exporter.submit();
+        if (finished) break;
+        std::this_thread::sleep_until(start + frame * period);
     }
 }
 
-void bubbleSort(std::vector<int>& arr, SDL_Renderer* renderer) {
-    for (size_t i = 0; i < arr.size() - 1; ++i) {
-        for (size_t j = 0; j < arr.size() - i - 1; ++j) {
-            handleEvents();
-            {
-                std::lock_guard<std::mutex> lock(mtx);
-                if (quit) return;  
-            }
-            waitForResume(); 
-            if (arr[j] > arr[j + 1]) {
-                std::swap(arr[j], arr[j + 1]);
-            }
-            renderSort(renderer, arr, j, j + 1, "bubble");
-            SDL_Delay(delay);
-        }
+// Pixel columns the array of the visualization in `slot` is reduced to before
+// publishing, or 0 if every element gets its own bar.
+size_t columnsFor(int slot, size_t elements) {
+    for (const Tile& tile : tiles) {
+        if (tile.slot == slot && useColumnMode(tile.rect.w, elements)) return tile.rect.w;
     }
+    return 0;
 }
 
-void merge(std::vector<int>& arr, int left, int mid, int right, SDL_Renderer* renderer) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
+// Feeds one tile from the engine's step stream. Steps are paced to
+// stepsPerSecond and the array is published to the tile's SharedView at most
+// once per display frame, so the sort can run far faster than the screen
+// updates. Pause and quit are honoured at each bail-out point.
+template <typename Highlight>
+class VisualizerSink {
+public:
+    VisualizerSink(int slot, const std::vector<int>& arr, ValueRange values)
+        : view(views[slot]), arr(arr), columns(columnsFor(slot, arr.size())), dirty{0, arr.size()}, values(values),
+          framePeriod(std::chrono::microseconds(1000000 / displayRefreshRate)) {
+        publish(-1, -1);
+        view.draw.store(&drawFrame<Highlight>, std::memory_order_release);
+        rebase(std::chrono::steady_clock::now());
+    }
 
-    std::vector<int> L(n1), R(n2);
-    for (int i = 0; i < n1; ++i) L[i] = arr[left + i];
-    for (int j = 0; j < n2; ++j) R[j] = arr[mid + 1 + j];
+    ~VisualizerSink() {
+        publish(-1, -1);
+    }
 
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        handleEvents();
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            if (quit) return;  
+    void emit(const Step& step) {
+        if (step.op == StepOp::Swap) {
+            touch(step.a);
+            touch(step.b);
+        } else if (step.op == StepOp::Write) {
+            touch(step.a);
         }
-        waitForResume(); 
-        if (L[i] <= R[j]) {
-            arr[k++] = L[i++];
+        lastA = step.a;
+        lastB = step.b;
+        if (++pending >= batch) pace();
+    }
+
+    bool stopped() {
+        if (paused.load(std::memory_order_relaxed)) waitForResume();
+        return quit.load(std::memory_order_relaxed);
+    }
+
+    void publish(size_t currentIndex, size_t secondIndex) {
+        ViewFrame& frame = view.frames.writeBuffer();
+        if (columns) {
+            // Only the columns covering indices written since the last
+            // publish need reducing again.
+            if (envelope.empty()) {
+                reduceColumns(arr, columns, envelope);
+            } else {
+                reduceColumns(arr, columns, envelope, columnsCovering(dirty, arr.size(), columns));
+            }
+            frame.columns.assign(envelope.begin(), envelope.end());
         } else {
-            arr[k++] = R[j++];
+            frame.arr.assign(arr.begin(), arr.end());
         }
-        renderSort(renderer, arr, k - 1, -1, "merge");
-        SDL_Delay(delay);
+        frame.elements = arr.size();
+        frame.dirty = dirty;
+        frame.values = values;
+        frame.sequence = ++sequence;
+        dirty = {arr.size(), 0};
+        frame.currentIndex = currentIndex;
+        frame.secondIndex = secondIndex;
+        frame.counters = opCounters;
+        view.frames.publish();
+        nextPublish = std::chrono::steady_clock::now() + framePeriod;
     }
 
-    while (i < n1) {
-        handleEvents();
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            if (quit) return;  
-        }
-        waitForResume(); 
-        arr[k++] = L[i++];
-        renderSort(renderer, arr, k - 1, -1, "merge");
-        SDL_Delay(delay);
+    // The array was changed behind the sink's back (a replay seek).
+    void invalidate() {
+        dirty = {0, arr.size()};
     }
-    while (j < n2) {
-        handleEvents();
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            if (quit) return;  
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void touch(int index) {
+        dirty.begin = std::min(dirty.begin, static_cast<size_t>(index));
+        dirty.end = std::max(dirty.end, static_cast<size_t>(index) + 1);
+    }
+
+    void rebase(Clock::time_point now) {
+        rate = std::max(stepsPerSecond.load(std::memory_order_relaxed), 1);
+        // Look at the clock roughly once a millisecond, not once a step.
+        batch = std::max(1, rate / 1000);
+        epoch = now;
+        stepsSinceEpoch = 0;
+    }
+
+    void pace() {
+        stepsSinceEpoch += pending;
+        pending = 0;
+
+        auto now = Clock::now();
+        auto due = epoch + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(stepsSinceEpoch / static_cast<double>(rate)));
+        bool sleeping = due > now;
+        if (sleeping || now >= nextPublish) publish(static_cast<size_t>(lastA), static_cast<size_t>(lastB));
+
+        if (sleeping) {
+            std::this_thread::sleep_until(due);
+        } else if (now - due > std::chrono::milliseconds(100)) {
+            // Fell behind (paused, or the machine cannot keep up): do not try
+            // to catch up in a burst.
+            rebase(now);
         }
-        waitForResume(); 
-        arr[k++] = R[j++];
-        renderSort(renderer, arr, k - 1, -1, "merge");
-        SDL_Delay(delay);
+        if (rate != std::max(stepsPerSecond.load(std::memory_order_relaxed), 1)) rebase(Clock::now());
     }
+
+    SharedView& view;
+    const std::vector<int>& arr;
+    size_t columns;
+    std::vector<ColumnSpan> envelope;
+    IndexRange dirty;
+    ValueRange values;
+    uint64_t sequence = 0;
+    Clock::duration framePeriod;
+    Clock::time_point epoch;
+    Clock::time_point nextPublish;
+    uint64_t stepsSinceEpoch = 0;
+    int rate = 1;
+    int batch = 1;
+    int pending = 0;
+    int lastA = -1;
+    int lastB = -1;
+};
+
+void printRunSummary(int option, const OpCounters& counters, bool finished) {
+    std::lock_guard<std::mutex> lock(console_mtx);
+    std::cout << CYAN << sortAlgorithmName(option) << (finished ? " finished: " : " stopped: ") << RESET
+              << counters.comparisons << " comparisons, " << counters.swaps << " swaps, " << counters.writes << " writes, "
+              << counters.auxBytes << " aux bytes in " << counters.allocations << " allocations, max recursion depth "
+              << counters.maxDepth << "\n";
 }
 
-void mergeSort(std::vector<int>& arr, int left, int right, SDL_Renderer* renderer) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSort(arr, left, mid, renderer);
-        mergeSort(arr, mid + 1, right, renderer);
-        merge(arr, left, mid, right, renderer);
+template <typename Highlight>
+void visualize(int option, std::vector<int>& arr) {
+    opCounters.reset();
+    VisualizerSink<Highlight> sink(option - 1, arr, {inputSpec.minValue, inputSpec.maxValue});
+    runSort(option, arr, sink);
+    printRunSummary(option, opCounters, std::is_sorted(arr.begin(), arr.end()));
+}
+
+void printInput(uint64_t seed, size_t size = inputSpec.size) {
+    std::lock_guard<std::mutex> lock(console_mtx);
+    std::cout << CYAN << "Input: " << size << " elements, " << distributionName(inputSpec.distribution) << " in ["
+              << inputSpec.minValue << ", " << inputSpec.maxValue << "], seed " << seed << RESET << "\n";
+}
+
+// Calls fn.template operator()<Highlight>() with the highlight policy that
+// draws `algorithm`'s steps, so live runs and replays colour it the same way.
+// Returns false for an unknown algorithm.
+template <typename Fn>
+bool visualizeWith(int algorithm, Fn fn) {
+    switch (algorithm) {
+        case 1: case 3: case 4: case 5: case 6: case 7: case 8: case 9: case 13:
+            fn.template operator()<PairHighlight>();
+            return true;
+        case 2:
+            fn.template operator()<InsertionHighlight>();
+            return true;
+        case 10: case 11: case 17:
+            fn.template operator()<BandHighlight>();
+            return true;
+        case 12:
+            fn.template operator()<NetworkHighlight>();
+            return true;
+        case 14:
+            fn.template operator()<HeapHighlight<2>>();
+            return true;
+        case 15:
+            fn.template operator()<HeapHighlight<4>>();
+            return true;
+        case 16:
+            fn.template operator()<HeapHighlight<8>>();
+            return true;
+        default:
+            return false;
     }
 }
 
-void quickSort(std::vector<int>& arr, int low, int high, SDL_Renderer* renderer) {
-    if (low < high) {
-        int pivot = arr[high];
-        int i = low - 1;
-        for (int j = low; j <= high - 1; ++j) {
-            handleEvents();
-            {
-                std::lock_guard<std::mutex> lock(mtx);
-                if (quit) return;  
-            }
-            waitForResume(); 
-            if (arr[j] < pivot) {
-                ++i;
-                std::swap(arr[i], arr[j]);
-            }
-            renderSort(renderer, arr, j, high, "quick");
-            SDL_Delay(delay);
-        }
-        std::swap(arr[i + 1], arr[high]);
-        renderSort(renderer, arr, i + 1, high, "quick");
-        SDL_Delay(delay);
-        
-        quickSort(arr, low, i, renderer);
-        quickSort(arr, i + 2, high, renderer);
+void executeSorting(int option, uint64_t seed) {
+    std::vector<int> arr = makeInput(seed);
+    if (!visualizeWith(option, [&]<typename Highlight>() { visualize<Highlight>(option, arr); })) {
+        std::cerr << "Invalid option!" << std::endl;
     }
 }
 
-void heapify(std::vector<int>& arr, int n, int i, SDL_Renderer* renderer) {
-    int largest = i;
-    int left = 2 * i + 1;
-    int right = 2 * i + 2;
+// Turns a pending Home/End/PageUp/PageDown request into a target step, or
+// returns false if nothing is pending.
+bool takeSeekRequest(uint64_t position, uint64_t length, uint64_t& target) {
+    if (seekPermille.load(std::memory_order_relaxed) < 0 && seekTenths.load(std::memory_order_relaxed) == 0) return false;
 
-    if (left < n && arr[left] > arr[largest]) largest = left;
-    if (right < n && arr[right] > arr[largest]) largest = right;
+    int permille = seekPermille.exchange(-1);
+    int tenths = seekTenths.exchange(0);
+    double base = permille >= 0 ? permille / 1000.0 * length : static_cast<double>(position);
+    double wanted = base + tenths * (length / 10.0);
+    target = static_cast<uint64_t>(std::clamp(wanted, 0.0, static_cast<double>(length)));
+    return true;
+}
 
-    if (largest != i) {
-        std::swap(arr[i], arr[largest]);
-        renderSort(renderer, arr, largest, i, "heap");
-        SDL_Delay(delay);
-        handleEvents();
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            if (quit) return;  
+// Traces hold no counters, so a replay notes the HUD counters every
+// REPLAY_COUNTER_SPACING steps as it first passes them. A seek restores the
+// nearest noted counters at or before the target and counts forward from
+// there.
+const uint64_t REPLAY_COUNTER_SPACING = 1 << 16;
+
+template <typename Highlight>
+void replaySteps(TraceReader& reader) {
+    std::vector<int> arr = reader.initialArray();
+    opCounters.reset();
+    std::vector<OpCounters> countersAt = {opCounters};
+    // The trace does not record the input's range; its values span it.
+    VisualizerSink<Highlight> sink(reader.algorithm() - 1, arr, valueRangeOf(arr));
+
+    // Reads the next step and applies it to arr and the counters.
+    auto advance = [&](Step& step) {
+        if (!reader.next(step)) return false;
+        applyStep(arr, step);
+        opCounters.count(step);
+        if (reader.position() == countersAt.size() * REPLAY_COUNTER_SPACING) countersAt.push_back(opCounters);
+        return true;
+    };
+
+    // Once the trace is exhausted the window stays up so it can still be
+    // scrubbed back with the seek keys until it is closed.
+    Step step;
+    while (!sink.stopped() && reader.ok()) {
+        uint64_t target;
+        if (takeSeekRequest(reader.position(), reader.stepCount(), target)) {
+            uint64_t noted = std::min<uint64_t>(target / REPLAY_COUNTER_SPACING, countersAt.size() - 1);
+            reader.seek(noted * REPLAY_COUNTER_SPACING, arr);
+            opCounters = countersAt[noted];
+            while (reader.position() < target && advance(step)) {}
+            sink.invalidate();
+            sink.publish(-1, -1);
+            continue;
         }
-        waitForResume(); 
-        heapify(arr, n, largest, renderer);
+        if (advance(step)) {
+            sink.emit(step);
+        } else {
+            sink.publish(-1, -1);
+            SDL_Delay(10);
+        }
+    }
+    if (!reader.ok()) {
+        std::cerr << RED << reader.error() << RESET << "\n";
     }
 }
 
-void heapSort(std::vector<int>& arr, SDL_Renderer* renderer) {
-    int n = arr.size();
-    for (int i = n / 2 - 1; i >= 0; i--) {
-        heapify(arr, n, i, renderer);
-        renderSort(renderer, arr, i, -1, "heap");
-        SDL_Delay(delay);
-    }
-    for (int i = n - 1; i > 0; i--) {
-        std::swap(arr[0], arr[i]);
-        renderSort(renderer, arr, i, -1, "heap");
-        SDL_Delay(delay);
-        heapify(arr, i, 0, renderer);
-    }
+void replayTrace(TraceReader& reader) {
+    // showReplayTraceMenu has already rejected unknown algorithms.
+    visualizeWith(reader.algorithm(), [&]<typename Highlight>() { replaySteps<Highlight>(reader); });
 }
 
-void executeSorting(int option) {
-    std::vector<int> arr(70);
-    for (int i = 0; i < 70; ++i) {
-        arr[i] = std::rand() % 100;
+void printAlgorithmChoices() {
+    for (int option = 1; option <= SORT_ALGORITHM_COUNT; ++option) {
+        std::cout << GREEN << option << ". " << sortAlgorithmName(option) << "\n" << RESET;
     }
+}
 
-    switch (option) {
-        case 1:
-            selectionSort(arr, renderers[0]);
-            break;
-        case 2:
-            insertionSort(arr, renderers[1]);
-            break;
-        case 3:
-            bubbleSort(arr, renderers[2]);
-            break;
-        case 4:
-            mergeSort(arr, 0, arr.size() - 1, renderers[3]);
-            break;
-        case 5:
-            quickSort(arr, 0, arr.size() - 1, renderers[4]);
-            break;
-        case 6:
-            heapSort(arr, renderers[5]);
-            break;
-        default:
-            std::cerr << "Invalid option!" << std::endl;
-            break;
-    }
+void waitForEnter() {
+    std::cout << CYAN << "\nPress Enter to return to the main menu..." << RESET << std::endl;
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    std::cin.get();
 }
 
 void showWelcomeMessage() {
@@ -471,9 +1257,19 @@ void showWelcomeMessage() {
     cout << GREEN << " - Bubble Sort" << RESET << endl;
     cout << GREEN << " - Quick Sort" << RESET << endl;
     cout << GREEN << " - Heap Sort" << RESET << endl;
+    cout << GREEN << " - Parallel Merge Sort" << RESET << endl;
+    cout << GREEN << " - Parallel Quick Sort" << RESET << endl;
+    cout << GREEN << " - Bottom-Up Merge Sort" << RESET << endl;
+    cout << GREEN << " - LSD Radix Sort" << RESET << endl;
+    cout << GREEN << " - MSD Radix Sort" << RESET << endl;
+    cout << GREEN << " - Bitonic Sort" << RESET << endl;
+    cout << GREEN << " - Pattern-Defeating Quick Sort" << RESET << endl;
+    cout << GREEN << " - Bottom-Up Heap Sort" << RESET << endl;
+    cout << GREEN << " - 4-ary Heap Sort" << RESET << endl;
+    cout << GREEN << " - 8-ary Heap Sort" << RESET << endl;
+    cout << GREEN << " - Powersort" << RESET << endl;
     cout << BLUE << "\nYou can speed up or slow down using the left and right arrow keys, respectively." << RESET << endl;
     cout << BLUE << "Press 'P' to pause and 'ESC' to quit the window." << RESET << endl;
-    cout << RED << "\nCaution: Pressing multiple keys during multiple visualizations may cause the program to crash!" << RESET << endl;
     cout << CYAN << "\nPress 'Y' to continue to the main menu..." << RESET << endl;
 
 
@@ -493,26 +1289,26 @@ void showmenu(){
         cout << GREEN << "1. One Visualization\n" << RESET;
         cout << GREEN << "2. Multiple Visualizations\n" << RESET;
         cout << GREEN << "3. Change Speed\n" << RESET;
-        cout << GREEN << "4. Exit\n" << RESET;
+        cout << GREEN << "4. Change Input\n" << RESET;
+        cout << GREEN << "5. Change Renderer\n" << RESET;
+        cout << GREEN << "6. Record Trace\n" << RESET;
+        cout << GREEN << "7. Replay Trace\n" << RESET;
+        cout << GREEN << "8. Export Video\n" << RESET;
+        cout << GREEN << "9. Exit\n" << RESET;
         cout << BLUE << "Enter your choice: " << RESET;
 }
 void showSingleVisualizationMenu() {
     clearScreen();
     int sortOption;
     std::cout << "Select sorting algorithm to visualize:\n";
-    std::cout << GREEN << "1. Selection Sort\n" << RESET;
-    std::cout << GREEN << "2. Insertion Sort\n" << RESET;
-    std::cout << GREEN << "3. Bubble Sort\n" << RESET;
-    std::cout << GREEN << "4. Merge Sort\n" << RESET;
-    std::cout << GREEN << "5. Quick Sort\n" << RESET;
-    std::cout << GREEN << "6. Heap Sort\n" << RESET;
-    std::cout << BLUE << "Enter your choice (1-6): " << RESET;
+    printAlgorithmChoices();
+    std::cout << BLUE << "Enter your choice (1-" << SORT_ALGORITHM_COUNT << "): " << RESET;
     std::cin >> sortOption;
 
-    if (std::cin.fail() || sortOption < 1 || sortOption > 6) {
+    if (std::cin.fail() || sortOption < 1 || sortOption > SORT_ALGORITHM_COUNT) {
         std::cin.clear();
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        std::cerr << RED << "Invalid choice! Please enter a number between 1 and 6." << RESET << "\n";
+        std::cerr << RED << "Invalid choice! Please enter a number between 1 and " << SORT_ALGORITHM_COUNT << "." << RESET << "\n";
         return;
     }
 
@@ -521,17 +1317,19 @@ void showSingleVisualizationMenu() {
         return;
     }
 
-    std::thread sortingThread(executeSorting, sortOption);
-    while (!quit) {
-        handleEvents();
-        SDL_Delay(10);
-    }
+    uint64_t seed = runSeed();
+    printInput(seed);
+    std::thread sortingThread(executeSorting, sortOption, seed);
+    runRenderLoop();
     sortingThread.join();
+    resetViews();
     close();
     quit = false;
 }
 
-void showMultipleVisualizationsMenu() {
+// Asks how many algorithms to run and which ones, each at most once. Returns
+// the count, or 0 if the count was invalid.
+int promptAlgorithms(int options[]) {
     clearScreen();
     int numSorts;
     std::cout << "How many sorting algorithms to visualize (1-" << MAX_VISUALIZATIONS << "): ";
@@ -541,49 +1339,203 @@ void showMultipleVisualizationsMenu() {
         std::cin.clear();
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         std::cerr << RED << "Invalid number of visualizations! Please enter a number between 1 and " << MAX_VISUALIZATIONS << "." << RESET << "\n";
-        return;
+        return 0;
     }
     clearScreen();
 
-    int options[6];
     std::cout << "Select the sorting algorithms to visualize:\n";
-    std::cout << GREEN << "1. Selection Sort\n" << RESET;
-    std::cout << GREEN << "2. Insertion Sort\n" << RESET;
-    std::cout << GREEN << "3. Bubble Sort\n" << RESET;
-    std::cout << GREEN << "4. Merge Sort\n" << RESET;
-    std::cout << GREEN << "5. Quick Sort\n" << RESET;
-    std::cout << GREEN << "6. Heap Sort\n" << RESET;
+    printAlgorithmChoices();
     for (int i = 0; i < numSorts; ++i) {
-        std::cout << BLUE << "Enter choice " << (i + 1) << " (1-6): " << RESET;
+        std::cout << BLUE << "Enter choice " << (i + 1) << " (1-" << SORT_ALGORITHM_COUNT << "): " << RESET;
         std::cin >> options[i];
 
-        if (std::cin.fail() || options[i] < 1 || options[i] > 6) {
+        if (std::cin.fail() || options[i] < 1 || options[i] > SORT_ALGORITHM_COUNT) {
             std::cin.clear();
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::cerr << RED << "Invalid choice! Please enter a number between 1 and 6." << RESET << "\n";
+            std::cerr << RED << "Invalid choice! Please enter a number between 1 and " << SORT_ALGORITHM_COUNT << "." << RESET << "\n";
             --i; 
+        } else if (std::find(options, options + i, options[i]) != options + i) {
+            // Each algorithm owns one tile and one published view.
+            std::cerr << RED << "That algorithm is already selected!" << RESET << "\n";
+            --i;
         }
     }
+    return numSorts;
+}
+
+void showMultipleVisualizationsMenu() {
+    int options[MAX_VISUALIZATIONS];
+    int numSorts = promptAlgorithms(options);
+    if (numSorts == 0) {
+        return;
+    }
 
     if (!init(options, numSorts)) {
         return;
     }
 
+    uint64_t seed = runSeed();
+    printInput(seed);
     std::vector<std::thread> threads;
     for (int i = 0; i < numSorts; ++i) {
-        threads.push_back(std::thread(executeSorting, options[i]));
+        threads.push_back(std::thread(executeSorting, options[i], seed));
     }
 
-    while (!quit) {
-        handleEvents();
-        SDL_Delay(10);
+    runRenderLoop();
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) thread.join();
     }
+    resetViews();
+    close();
+    quit = false;
+}
+
+void showRecordTraceMenu() {
+    clearScreen();
+    int sortOption;
+    std::cout << "Select sorting algorithm to record:\n";
+    printAlgorithmChoices();
+    std::cout << BLUE << "Enter your choice (1-" << SORT_ALGORITHM_COUNT << "): " << RESET;
+    std::cin >> sortOption;
+
+    int size;
+    std::cout << BLUE << "Number of elements: " << RESET;
+    std::cin >> size;
+
+    if (std::cin.fail() || sortOption < 1 || sortOption > SORT_ALGORITHM_COUNT || size < 1) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cerr << RED << "Invalid algorithm or size!" << RESET << "\n";
+        return;
+    }
+
+    std::string path;
+    std::cout << BLUE << "Trace file to write: " << RESET;
+    std::cin >> path;
+
+    uint64_t seed = runSeed();
+    printInput(seed, size);
+    std::vector<int> arr = makeInput(seed, size);
+
+    TraceRecorder recorder(path, sortOption, arr);
+    if (!recorder.ok()) {
+        std::cerr << RED << "Could not open " << path << " for writing!" << RESET << "\n";
+        waitForEnter();
+        return;
+    }
+
+    opCounters.reset();
+    auto start = std::chrono::steady_clock::now();
+    runSort(sortOption, arr, recorder);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    if (!recorder.finish()) {
+        std::cerr << RED << "Failed while writing " << path << "!" << RESET << "\n";
+    } else {
+        std::cout << GREEN << "Recorded " << recorder.stepCount() << " steps of " << sortAlgorithmName(sortOption)
+                  << " in " << elapsed.count() << " ms (" << recorder.bytesWritten() << " bytes)." << RESET << "\n";
+        printRunSummary(sortOption, opCounters, true);
+    }
+    waitForEnter();
+}
+
+void showReplayTraceMenu() {
+    clearScreen();
+    std::string path;
+    std::cout << BLUE << "Trace file to replay: " << RESET;
+    std::cin >> path;
+
+    TraceReader reader(path);
+    if (!reader.ok() || reader.algorithm() < 1 || reader.algorithm() > SORT_ALGORITHM_COUNT) {
+        std::cerr << RED << (reader.ok() ? "Trace was recorded with an unknown algorithm." : reader.error()) << RESET << "\n";
+        waitForEnter();
+        return;
+    }
+
+    int options[] = {reader.algorithm()};
+    if (!init(options, 1)) {
+        return;
+    }
+    std::cout << GREEN << "Replaying " << reader.stepCount() << " steps of " << sortAlgorithmName(reader.algorithm()) << ".\n" << RESET;
+    std::cout << BLUE << "Home/End jump to the start/end, PageUp/PageDown seek by a tenth of the trace." << RESET << "\n";
+
+    seekPermille = -1;
+    seekTenths = 0;
+    std::thread replayThread(replayTrace, std::ref(reader));
+    runRenderLoop();
+    replayThread.join();
+    resetViews();
+    close();
+    quit = false;
+}
+
+void showExportMenu() {
+    int options[MAX_VISUALIZATIONS];
+    int numSorts = promptAlgorithms(options);
+    if (numSorts == 0) {
+        return;
+    }
+
+    int formatOption;
+    std::cout << CYAN << "Export format:\n" << RESET;
+    std::cout << GREEN << "1. Y4M video (one uncompressed file)\n" << RESET;
+    std::cout << GREEN << "2. PNG image sequence\n" << RESET;
+    std::cout << BLUE << "Enter your choice: " << RESET;
+    std::cin >> formatOption;
+
+    int fps;
+    std::cout << BLUE << "Frames per second (1-" << MAX_EXPORT_FPS << "): " << RESET;
+    std::cin >> fps;
+
+    if (std::cin.fail() || formatOption < 1 || formatOption > 2 || fps < 1 || fps > MAX_EXPORT_FPS) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cerr << RED << "Invalid format or frame rate!" << RESET << "\n";
+        return;
+    }
+    FrameFormat format = formatOption == 1 ? FrameFormat::Y4M : FrameFormat::PNG;
+
+    std::string path;
+    std::cout << BLUE << (format == FrameFormat::Y4M ? "Video file to write: " : "File name prefix for the frames: ") << RESET;
+    std::cin >> path;
+
+    if (!initOffscreen(options, numSorts, fps)) {
+        waitForEnter();
+        return;
+    }
+    FrameExporter exporter(path, format, offscreenSurface->w, offscreenSurface->h, fps);
+    std::cout << GREEN << "Exporting at " << fps << " frames/s and " << stepsPerSecond << " steps/s..." << RESET << "\n";
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t seed = runSeed();
+    printInput(seed);
+    activeSorts = numSorts;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numSorts; ++i) {
+        threads.push_back(std::thread([option = options[i], seed] {
+            executeSorting(option, seed);
+            --activeSorts;
+        }));
+    }
+
+    runExportLoop(exporter, fps);
 
     for (auto& thread : threads) {
         if (thread.joinable()) thread.join();
     }
+    bool written = exporter.finish();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    resetViews();
     close();
     quit = false;
+
+    if (!written) {
+        std::cerr << RED << exporter.error() << RESET << "\n";
+    } else {
+        std::cout << GREEN << "Wrote " << exporter.framesWritten() << " frames to " << path << " in " << elapsed.count() << " s." << RESET << "\n";
+    }
+    waitForEnter();
 }
 
 void changeSpeed() {
@@ -593,31 +1545,119 @@ void changeSpeed() {
     std::cout << GREEN << "1. Slow\n" << RESET;
     std::cout << GREEN << "2. Medium\n" << RESET;
     std::cout << GREEN << "3. Fast\n" << RESET;
+    std::cout << GREEN << "4. Very Fast (many steps per frame)\n" << RESET;
+    std::cout << GREEN << "5. Custom steps per second\n" << RESET;
     std::cout << BLUE << "Enter your choice: " << RESET;
     std::cin >> speedOption;
 
     switch (speedOption) {
         case 1:
-            delay = 300;
+            stepsPerSecond = 3;
             break;
         case 2:
-            delay = 100;
+            stepsPerSecond = 10;
             break;
         case 3:
-            delay = 50;
+            stepsPerSecond = 20;
             break;
+        case 4:
+            stepsPerSecond = 100000;
+            break;
+        case 5: {
+            std::cout << BLUE << "Steps per second (1-" << MAX_STEPS_PER_SECOND << "): " << RESET;
+            int rate;
+            std::cin >> rate;
+            if (std::cin.fail() || rate < 1 || rate > MAX_STEPS_PER_SECOND) {
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::cerr << RED << "Invalid value! Using default speed (Medium).\n" << RESET;
+                rate = 10;
+            }
+            stepsPerSecond = rate;
+            break;
+        }
         default:
             std::cerr << RED << "Invalid choice! Using default speed (Medium).\n" << RESET;
-            delay = 100;
+            stepsPerSecond = 10;
             break;
     }
 }
 
 
+// Asks for the input of the next runs: size, distribution, value range and
+// seed. An invalid answer keeps that setting and the ones after it.
+void changeInput() {
+    clearScreen();
+    auto invalid = [](const char* message) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cerr << RED << message << RESET;
+    };
+
+    int size;
+    std::cout << CYAN << "Elements per visualization (currently " << inputSpec.size << ").\n" << RESET;
+    std::cout << GREEN << "Arrays too wide for one bar per element are drawn as per-column min/max envelopes.\n" << RESET;
+    std::cout << BLUE << "Number of elements (1-" << MAX_ARRAY_SIZE << "): " << RESET;
+    std::cin >> size;
+    if (std::cin.fail() || size < 1 || size > MAX_ARRAY_SIZE) {
+        invalid("Invalid size! Keeping the current input.\n");
+        return;
+    }
+    inputSpec.size = size;
 
-int main() {
-    srand(static_cast<unsigned int>(time(0)));
+    int distribution;
+    std::cout << CYAN << "Distribution (currently " << distributionName(inputSpec.distribution) << "):\n" << RESET;
+    for (int d = 0; d < static_cast<int>(Distribution::Count); ++d) {
+        std::cout << GREEN << (d + 1) << ". " << distributionName(static_cast<Distribution>(d)) << "\n" << RESET;
+    }
+    std::cout << BLUE << "Enter your choice: " << RESET;
+    std::cin >> distribution;
+    if (std::cin.fail() || distribution < 1 || distribution > static_cast<int>(Distribution::Count)) {
+        invalid("Invalid distribution! Keeping the rest of the input.\n");
+        return;
+    }
+    inputSpec.distribution = static_cast<Distribution>(distribution - 1);
 
+    int minValue, maxValue;
+    std::cout << BLUE << "Smallest and largest value (currently " << inputSpec.minValue << " " << inputSpec.maxValue << "): " << RESET;
+    std::cin >> minValue >> maxValue;
+    if (std::cin.fail() || minValue > maxValue) {
+        invalid("Invalid range! Keeping the rest of the input.\n");
+        return;
+    }
+    inputSpec.minValue = minValue;
+    inputSpec.maxValue = maxValue;
+
+    uint64_t seed;
+    std::cout << BLUE << "Seed, or 0 for a new one every run (currently " << inputSpec.seed << "): " << RESET;
+    std::cin >> seed;
+    if (std::cin.fail()) {
+        invalid("Invalid seed! Keeping the current one.\n");
+        return;
+    }
+    inputSpec.seed = seed;
+}
+
+void changeRenderer() {
+    clearScreen();
+    int backendOption;
+    std::cout << CYAN << "Select how bars are drawn:\n" << RESET;
+    std::cout << GREEN << "1. Batched rectangles (GPU draw calls)\n" << RESET;
+    std::cout << GREEN << "2. Pixel rasterizer (CPU, streaming texture)\n" << RESET;
+    std::cout << BLUE << "Enter your choice: " << RESET;
+    std::cin >> backendOption;
+
+    if (std::cin.fail() || backendOption < 1 || backendOption > 2) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cerr << RED << "Invalid choice! Keeping the current renderer.\n" << RESET;
+        return;
+    }
+    renderBackend = backendOption == 1 ? BACKEND_RECTS : BACKEND_PIXELS;
+}
+
+
+int main() {
     showWelcomeMessage();
     int menuChoice;
     bool running = true;
@@ -627,10 +1667,10 @@ int main() {
         showmenu();
         std::cin >> menuChoice;
 
-        if (std::cin.fail() || menuChoice < 1 || menuChoice > 4) {
+        if (std::cin.fail() || menuChoice < 1 || menuChoice > 9) {
             std::cin.clear();
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::cerr << RED << "Invalid choice! Please enter a number between 1 and 4." << RESET << "\n";
+            std::cerr << RED << "Invalid choice! Please enter a number between 1 and 9." << RESET << "\n";
             continue;
         }
 
@@ -645,10 +1685,25 @@ int main() {
                 changeSpeed();
                 break;
             case 4:
+                changeInput();
+                break;
+            case 5:
+                changeRenderer();
+                break;
+            case 6:
+                showRecordTraceMenu();
+                break;
+            case 7:
+                showReplayTraceMenu();
+                break;
+            case 8:
+                showExportMenu();
+                break;
+            case 9:
                 running = false;
                 break;
             default:
-                std::cerr << RED << "Invalid choice! Please enter a number between 1 and 4." << RESET << "\n";
+                std::cerr << RED << "Invalid choice! Please enter a number between 1 and 9." << RESET << "\n";
                 break;
         }
     }
@@ -0,0 +1,1551 @@
+#pragma once
+
+// Headless sorting engine. The algorithms know nothing about SDL: every
+// comparison, swap, write and pivot choice is reported to a sink, and the sink
+// decides what to do with it (draw it, record it, count it or ignore it).
+// Sinks are template parameters, so a sink with empty inline members costs
+// nothing and the algorithms run at native speed.
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "sort_network.h"
+#include "task_pool.h"
+
+enum class StepOp : uint8_t {
+    Compare,  // a and b were compared
+    Swap,     // a and b were exchanged (already applied to the array)
+    Write,    // arr[a] = value (already applied); b is a context index or -1
+    Pivot     // a was chosen as pivot for the range ending at b
+};
+
+struct Step {
+    StepOp op;
+    int a;
+    int b;
+    int value;
+};
+
+// emit() receives every step after it has been applied to the array.
+// stopped() is polled at the points where the algorithms can bail out early.
+template <typename S>
+concept StepSink = requires(S& sink, const Step& step) {
+    sink.emit(step);
+    { sink.stopped() } -> std::convertible_to<bool>;
+};
+
+struct NullSink {
+    static constexpr bool CONCURRENT = true;
+    static constexpr bool SILENT = true;
+    void emit(const Step&) {}
+    constexpr bool stopped() const { return false; }
+};
+
+// A sink that sets CONCURRENT may be called from several threads at once.
+// The parallel algorithms only fan out onto the task pool for such sinks; for
+// any other (the visualizer, the trace recorder) they run their tasks inline,
+// so the sink still sees one ordered step stream.
+template <typename S>
+constexpr bool sinkIsConcurrent() {
+    if constexpr (requires { S::CONCURRENT; }) {
+        return S::CONCURRENT;
+    } else {
+        return false;
+    }
+}
+
+// A sink that sets SILENT ignores the individual steps, so an algorithm may
+// batch work that would otherwise be reported step by step (the vectorized
+// sorting networks) and only add the operation counts in bulk.
+template <typename S>
+constexpr bool sinkIsSilent() {
+    if constexpr (requires { S::SILENT; }) {
+        return S::SILENT;
+    } else {
+        return false;
+    }
+}
+
+// Per-thread operation counters. Every algorithm updates the counters of the
+// thread it runs on, so concurrent sorts never share a cache line or a lock
+// and the hot loops pay a plain increment per step. Call reset() before a run.
+struct OpCounters {
+    uint64_t comparisons = 0;
+    uint64_t swaps = 0;
+    uint64_t writes = 0;
+    uint64_t auxBytes = 0;     // scratch memory allocated over the whole run
+    uint64_t allocations = 0;  // number of scratch allocations
+    int depth = 0;             // current recursion depth
+    int maxDepth = 0;
+
+    void reset() { *this = OpCounters{}; }
+
+    void add(const OpCounters& other) {
+        comparisons += other.comparisons;
+        swaps += other.swaps;
+        writes += other.writes;
+        auxBytes += other.auxBytes;
+        allocations += other.allocations;
+        maxDepth = std::max(maxDepth, other.maxDepth);
+    }
+
+    void count(const Step& step) {
+        switch (step.op) {
+            case StepOp::Compare: ++comparisons; break;
+            case StepOp::Swap: ++swaps; break;
+            case StepOp::Write: ++writes; break;
+            case StepOp::Pivot: break;
+        }
+    }
+};
+
+inline thread_local OpCounters opCounters;
+
+// Counts a step and forwards it to the sink. Algorithms report through this
+// rather than calling sink.emit directly.
+template <StepSink Sink>
+inline void emitStep(Sink& sink, const Step& step) {
+    opCounters.count(step);
+    sink.emit(step);
+}
+
+inline void noteAllocation(std::size_t bytes) {
+    opCounters.auxBytes += bytes;
+    ++opCounters.allocations;
+}
+
+// Tracks recursion depth for the lifetime of one recursive call.
+struct DepthScope {
+    DepthScope() {
+        if (++opCounters.depth > opCounters.maxDepth) opCounters.maxDepth = opCounters.depth;
+    }
+    ~DepthScope() { --opCounters.depth; }
+    DepthScope(const DepthScope&) = delete;
+    DepthScope& operator=(const DepthScope&) = delete;
+};
+
+template <StepSink Sink>
+void selectionSort(std::vector<int>& arr, Sink& sink) {
+    for (std::size_t i = 0; i + 1 < arr.size(); ++i) {
+        std::size_t minIndex = i;
+        for (std::size_t j = i + 1; j < arr.size(); ++j) {
+            if (sink.stopped()) return;
+            if (arr[j] < arr[minIndex]) {
+                minIndex = j;
+            }
+            emitStep(sink, {StepOp::Compare, static_cast<int>(j), static_cast<int>(minIndex), 0});
+        }
+        std::swap(arr[i], arr[minIndex]);
+        emitStep(sink, {StepOp::Swap, static_cast<int>(i), static_cast<int>(minIndex), 0});
+    }
+}
+
+template <StepSink Sink>
+void insertionSort(std::vector<int>& arr, Sink& sink) {
+    for (std::size_t i = 1; i < arr.size(); ++i) {
+        int key = arr[i];
+        std::size_t j = i - 1;
+
+        while (j < arr.size()) {
+            if (sink.stopped()) return;
+            emitStep(sink, {StepOp::Compare, static_cast<int>(j), static_cast<int>(i), 0});
+            if (!(arr[j] > key)) break;
+            arr[j + 1] = arr[j];
+            emitStep(sink, {StepOp::Write, static_cast<int>(j + 1), static_cast<int>(i), arr[j + 1]});
+            j--;
+        }
+        arr[j + 1] = key;
+        emitStep(sink, {StepOp::Write, static_cast<int>(j + 1), static_cast<int>(i), key});
+    }
+}
+
+// Insertion sort of arr[lo, hi), reported like insertionSort.
+template <StepSink Sink>
+void insertionSortRange(std::vector<int>& arr, int lo, int hi, Sink& sink) {
+    for (int i = lo + 1; i < hi; ++i) {
+        int key = arr[i];
+        int j = i - 1;
+        while (j >= lo) {
+            if (sink.stopped()) return;
+            emitStep(sink, {StepOp::Compare, j, i, 0});
+            if (!(arr[j] > key)) break;
+            arr[j + 1] = arr[j];
+            emitStep(sink, {StepOp::Write, j + 1, i, arr[j + 1]});
+            --j;
+        }
+        arr[j + 1] = key;
+        emitStep(sink, {StepOp::Write, j + 1, i, key});
+    }
+}
+
+template <StepSink Sink>
+void bubbleSort(std::vector<int>& arr, Sink& sink) {
+    for (std::size_t i = 0; i + 1 < arr.size(); ++i) {
+        for (std::size_t j = 0; j + i + 1 < arr.size(); ++j) {
+            if (sink.stopped()) return;
+            emitStep(sink, {StepOp::Compare, static_cast<int>(j), static_cast<int>(j + 1), 0});
+            if (arr[j] > arr[j + 1]) {
+                std::swap(arr[j], arr[j + 1]);
+                emitStep(sink, {StepOp::Swap, static_cast<int>(j), static_cast<int>(j + 1), 0});
+            }
+        }
+    }
+}
+
+// Ranges at most this long are finished by a sorting network in mergeSort and
+// quickSort.
+const int SORT_NETWORK_CUTOFF = 16;
+
+// One stage of the bitonic network over arr[lo, lo + n): each i is paired with
+// i ^ mask and the smaller key goes first. Pairs that fall past n are skipped;
+// they would meet an INT_MAX pad and never exchange. Every comparator is one
+// Compare, plus a Swap when the pair was out of order.
+template <StepSink Sink>
+void networkStage(std::vector<int>& arr, int lo, int n, int mask, Sink& sink) {
+    for (int i = 0; i < n; ++i) {
+        int l = i ^ mask;
+        if (l <= i || l >= n) continue;
+        if (sink.stopped()) return;
+        emitStep(sink, {StepOp::Compare, lo + i, lo + l, 0});
+        if (arr[lo + i] > arr[lo + l]) {
+            std::swap(arr[lo + i], arr[lo + l]);
+            emitStep(sink, {StepOp::Swap, lo + i, lo + l, 0});
+        }
+    }
+}
+
+// Bitonic network stages for block sizes fromK..toK over arr[lo, lo + n);
+// every block of fromK / 2 keys must already be sorted.
+template <StepSink Sink>
+void networkStages(std::vector<int>& arr, int lo, int n, int fromK, int toK, Sink& sink) {
+    for (int k = fromK; k <= toK; k *= 2) {
+        networkStage(arr, lo, n, k - 1, sink);
+        for (int j = k / 4; j > 0; j /= 2) networkStage(arr, lo, n, j, sink);
+    }
+}
+
+// Sorts arr[lo, lo + n), n <= SORT_NETWORK_MAX, with a bitonic network. A
+// silent sink gets the SIMD kernel and the comparator count of the padded
+// network; exchanges are not counted on that path.
+template <StepSink Sink>
+void networkSortRange(std::vector<int>& arr, int lo, int n, Sink& sink) {
+    if (n < 2) return;
+    if constexpr (sinkIsSilent<Sink>()) {
+        opCounters.comparisons += sortNetworkComparators(n);
+        sortNetworkBlock(arr.data() + lo, n);
+    } else {
+        int padded = 2;
+        while (padded < n) padded *= 2;
+        networkStages(arr, lo, n, 2, padded, sink);
+    }
+}
+
+// Scratch memory for one sort run. The run creates one arena and hands it down
+// the recursion; it only allocates (and counts an allocation) when a request
+// outgrows what it already holds, so sizing it up front means one allocation
+// per run instead of one or two per merge.
+class ScratchArena {
+public:
+    std::vector<int>& ints(std::size_t n) {
+        if (buffer.size() < n) {
+            noteAllocation(n * sizeof(int));
+            buffer.resize(n);
+        }
+        return buffer;
+    }
+
+private:
+    std::vector<int> buffer;
+};
+
+// Merges src[a, aEnd) and src[b, bEnd) into dst from `out` on. src and dst
+// share arr's indexing. Compares are reported as (destination slot, head of
+// the right run); the right run's head has not been overwritten yet, the left
+// one may have been. Writes are only reported when dst is the array itself
+// (reportWrites), since writes into a scratch buffer do not change it.
+template <StepSink Sink>
+void mergeRuns(std::vector<int>& dst, const std::vector<int>& src, int a, int aEnd, int b, int bEnd, int out, Sink& sink, bool reportWrites = true) {
+    while (a < aEnd && b < bEnd) {
+        if (sink.stopped()) return;
+        emitStep(sink, {StepOp::Compare, out, b, 0});
+        dst[out] = src[a] <= src[b] ? src[a++] : src[b++];
+        if (reportWrites) emitStep(sink, {StepOp::Write, out, -1, dst[out]});
+        ++out;
+    }
+    for (; a < aEnd; ++a, ++out) {
+        if (sink.stopped()) return;
+        dst[out] = src[a];
+        if (reportWrites) emitStep(sink, {StepOp::Write, out, -1, dst[out]});
+    }
+    for (; b < bEnd; ++b, ++out) {
+        if (sink.stopped()) return;
+        dst[out] = src[b];
+        if (reportWrites) emitStep(sink, {StepOp::Write, out, -1, dst[out]});
+    }
+}
+
+// Merges arr[left, mid] and arr[mid + 1, right] through the run's scratch.
+template <StepSink Sink>
+void merge(std::vector<int>& arr, int left, int mid, int right, ScratchArena& arena, Sink& sink) {
+    std::vector<int>& scratch = arena.ints(arr.size());
+    std::copy(arr.begin() + left, arr.begin() + right + 1, scratch.begin() + left);
+    mergeRuns(arr, scratch, left, mid + 1, mid + 1, right + 1, left, sink);
+}
+
+template <StepSink Sink>
+void mergeSort(std::vector<int>& arr, int left, int right, ScratchArena& arena, Sink& sink) {
+    DepthScope scope;
+    if (right - left < SORT_NETWORK_CUTOFF) {
+        networkSortRange(arr, left, right - left + 1, sink);
+    } else {
+        int mid = left + (right - left) / 2;
+        mergeSort(arr, left, mid, arena, sink);
+        mergeSort(arr, mid + 1, right, arena, sink);
+        if (sink.stopped()) return;
+        merge(arr, left, mid, right, arena, sink);
+    }
+}
+
+template <StepSink Sink>
+void mergeSort(std::vector<int>& arr, Sink& sink) {
+    ScratchArena arena;
+    arena.ints(arr.size());
+    mergeSort(arr, 0, static_cast<int>(arr.size()) - 1, arena, sink);
+}
+
+// Iterative merge sort: passes of doubling width that merge from the array
+// into the scratch buffer and back, so nothing is copied between merges.
+template <StepSink Sink>
+void bottomUpMergeSort(std::vector<int>& arr, Sink& sink) {
+    int n = static_cast<int>(arr.size());
+    ScratchArena arena;
+    std::vector<int>& buffer = arena.ints(arr.size());
+
+    int passes = 0;
+    for (int width = 1; width < n; width *= 2) ++passes;
+    int width = 1;
+    if (passes % 2 == 1) {
+        // An odd number of passes would leave the result in the buffer.
+        // Sorting pairs in place first makes the rest even, so the last pass
+        // lands in arr.
+        for (int i = 0; i + 1 < n; i += 2) {
+            if (sink.stopped()) return;
+            emitStep(sink, {StepOp::Compare, i, i + 1, 0});
+            if (arr[i] > arr[i + 1]) {
+                std::swap(arr[i], arr[i + 1]);
+                emitStep(sink, {StepOp::Swap, i, i + 1, 0});
+            }
+        }
+        width = 2;
+    }
+
+    bool inArray = true;
+    for (; width < n; width *= 2) {
+        std::vector<int>& src = inArray ? arr : buffer;
+        std::vector<int>& dst = inArray ? buffer : arr;
+        for (int lo = 0; lo < n; lo += 2 * width) {
+            if (sink.stopped()) return;
+            int mid = std::min(lo + width, n);
+            int hi = std::min(lo + 2 * width, n);
+            mergeRuns(dst, src, lo, mid, mid, hi, lo, sink, !inArray);
+        }
+        inArray = !inArray;
+    }
+}
+
+// Natural runs shorter than this are extended by binary insertion sort.
+const int POWERSORT_MIN_RUN = 32;
+// Consecutive wins by one side of a merge after which it switches to galloping.
+const int POWERSORT_MIN_GALLOP = 7;
+
+// Steps of the adaptive merge sort are reported as (slot, start of the run
+// being detected or merged), so a sink can draw the run as a band.
+
+// Number of keys in p[0, len) that are less than key (strict) or at most key,
+// found by galloping: probe offsets 1, 3, 7, ... then binary search the last gap.
+template <StepSink Sink>
+int gallop(const int* p, int len, int key, bool strict, int slot, int start, Sink& sink) {
+    auto before = [&](int i) {
+        emitStep(sink, {StepOp::Compare, slot, start, 0});
+        return strict ? p[i] < key : p[i] <= key;
+    };
+    int lo = 0, hi = 1;
+    while (hi <= len && before(hi - 1)) {
+        lo = hi;
+        hi = 2 * hi + 1;
+    }
+    hi = std::min(hi, len + 1) - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (before(mid)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Finds the natural run starting at lo and returns its end. A strictly
+// descending run is reversed in place; one shorter than POWERSORT_MIN_RUN is
+// extended by binary insertion sort.
+template <StepSink Sink>
+int extendRun(std::vector<int>& arr, int lo, int n, Sink& sink) {
+    int end = lo + 1;
+    if (end < n) {
+        emitStep(sink, {StepOp::Compare, end, lo, 0});
+        if (arr[end] < arr[lo]) {
+            while (end + 1 < n) {
+                emitStep(sink, {StepOp::Compare, end + 1, lo, 0});
+                if (!(arr[end + 1] < arr[end])) break;
+                ++end;
+            }
+            ++end;
+            for (int i = lo, j = end - 1; i < j; ++i, --j) {
+                std::swap(arr[i], arr[j]);
+                emitStep(sink, {StepOp::Swap, i, j, 0});
+            }
+        } else {
+            while (end + 1 < n) {
+                emitStep(sink, {StepOp::Compare, end + 1, lo, 0});
+                if (arr[end + 1] < arr[end]) break;
+                ++end;
+            }
+            ++end;
+        }
+    }
+
+    int forced = std::min(lo + POWERSORT_MIN_RUN, n);
+    for (; end < forced; ++end) {
+        if (sink.stopped()) return end;
+        int key = arr[end];
+        // Upper bound keeps equal keys in input order.
+        int at = lo, hi = end;
+        while (at < hi) {
+            int mid = at + (hi - at) / 2;
+            emitStep(sink, {StepOp::Compare, mid, lo, 0});
+            if (key < arr[mid]) {
+                hi = mid;
+            } else {
+                at = mid + 1;
+            }
+        }
+        for (int j = end; j > at; --j) {
+            arr[j] = arr[j - 1];
+            emitStep(sink, {StepOp::Write, j, lo, arr[j]});
+        }
+        arr[at] = key;
+        emitStep(sink, {StepOp::Write, at, lo, key});
+    }
+    return end;
+}
+
+// Stable merge of the adjacent runs arr[lo, mid) and arr[mid, hi). Keys
+// already in place at either end are skipped first, then the left rest is
+// moved to scratch and merged forward. Once one side wins minGallop times in
+// a row the merge gallops, copying whole stretches of that side at once;
+// minGallop adapts to how well galloping pays off and carries over between
+// merges.
+template <StepSink Sink>
+void mergeGalloping(std::vector<int>& arr, int lo, int mid, int hi, int& minGallop, ScratchArena& arena, Sink& sink) {
+    int start = lo;
+    lo += gallop(arr.data() + lo, mid - lo, arr[mid], false, lo, start, sink);
+    if (lo == mid) return;
+    hi = mid + gallop(arr.data() + mid, hi - mid, arr[mid - 1], true, mid, start, sink);
+
+    int na = mid - lo;
+    std::vector<int>& scratch = arena.ints(na);
+    std::copy(arr.begin() + lo, arr.begin() + mid, scratch.begin());
+    int i = 0, j = mid, out = lo;
+    auto put = [&](int v) {
+        arr[out] = v;
+        emitStep(sink, {StepOp::Write, out, start, v});
+        ++out;
+    };
+
+    while (i < na && j < hi) {
+        if (sink.stopped()) return;
+        // One of the two win counters is always zero.
+        int winsLeft = 0, winsRight = 0;
+        while (i < na && j < hi && (winsLeft | winsRight) < minGallop) {
+            emitStep(sink, {StepOp::Compare, out, start, 0});
+            bool right = arr[j] < scratch[i];
+            put(right ? arr[j++] : scratch[i++]);
+            winsRight = right ? winsRight + 1 : 0;
+            winsLeft = right ? 0 : winsLeft + 1;
+        }
+        while (i < na && j < hi) {
+            if (sink.stopped()) return;
+            int fromLeft = gallop(scratch.data() + i, na - i, arr[j], false, out, start, sink);
+            for (int k = 0; k < fromLeft; ++k) put(scratch[i++]);
+            if (i == na) break;
+            put(arr[j++]);
+            if (j == hi) break;
+            int fromRight = gallop(arr.data() + j, hi - j, scratch[i], true, out, start, sink);
+            for (int k = 0; k < fromRight; ++k) put(arr[j++]);
+            if (j == hi) break;
+            put(scratch[i++]);
+            minGallop = std::max(1, minGallop - 1);
+            if (fromLeft < POWERSORT_MIN_GALLOP && fromRight < POWERSORT_MIN_GALLOP) {
+                minGallop += 2;
+                break;
+            }
+        }
+    }
+    // Whatever is left of the right run is already in place.
+    while (i < na) put(scratch[i++]);
+}
+
+// Powersort's merge priority for the boundary between the adjacent runs
+// [s1, s1 + n1) and [s1 + n1, s1 + n1 + n2): the first bit in which the
+// runs' midpoints, as fractions of n, differ. Boundaries with a larger power
+// are merged first.
+inline int powersortPower(int s1, int n1, int n2, int n) {
+    int64_t a = 2 * static_cast<int64_t>(s1) + n1;
+    int64_t b = a + n1 + n2;
+    int power = 0;
+    while (true) {
+        ++power;
+        if (a >= n) {
+            a -= n;
+            b -= n;
+        } else if (b >= n) {
+            return power;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+}
+
+// Adaptive natural-run merge sort with the powersort merge policy. Runs are
+// found left to right and kept on a stack; a merge happens when a boundary's
+// power drops below the one before it, which gives nearly optimal merge
+// trees for any pattern of run lengths. Sorted and reversed input is one run
+// and costs n - 1 comparisons.
+template <StepSink Sink>
+void powerSort(std::vector<int>& arr, Sink& sink) {
+    struct Run {
+        int start;
+        int length;
+        int power;  // of the boundary with the run below it on the stack
+    };
+    int n = static_cast<int>(arr.size());
+    ScratchArena arena;
+    arena.ints(n);
+    std::vector<Run> stack;
+    int minGallop = POWERSORT_MIN_GALLOP;
+    auto mergeTop = [&] {
+        Run top = stack.back();
+        stack.pop_back();
+        Run& below = stack.back();
+        mergeGalloping(arr, below.start, top.start, top.start + top.length, minGallop, arena, sink);
+        below.length += top.length;
+    };
+
+    for (int lo = 0; lo < n;) {
+        if (sink.stopped()) return;
+        int end = extendRun(arr, lo, n, sink);
+        Run run{lo, end - lo, 0};
+        if (!stack.empty()) {
+            run.power = powersortPower(stack.back().start, stack.back().length, run.length, n);
+            while (stack.size() >= 2 && stack.back().power > run.power) {
+                if (sink.stopped()) return;
+                mergeTop();
+            }
+        }
+        stack.push_back(run);
+        lo = end;
+    }
+    while (stack.size() >= 2) {
+        if (sink.stopped()) return;
+        mergeTop();
+    }
+}
+
+template <StepSink Sink>
+void quickSort(std::vector<int>& arr, int low, int high, Sink& sink) {
+    DepthScope scope;
+    if (high - low < SORT_NETWORK_CUTOFF) {
+        networkSortRange(arr, low, high - low + 1, sink);
+    } else {
+        int pivot = arr[high];
+        emitStep(sink, {StepOp::Pivot, high, high, pivot});
+        int i = low - 1;
+        for (int j = low; j <= high - 1; ++j) {
+            if (sink.stopped()) return;
+            emitStep(sink, {StepOp::Compare, j, high, 0});
+            if (arr[j] < pivot) {
+                ++i;
+                std::swap(arr[i], arr[j]);
+                emitStep(sink, {StepOp::Swap, i, j, 0});
+            }
+        }
+        std::swap(arr[i + 1], arr[high]);
+        emitStep(sink, {StepOp::Swap, i + 1, high, 0});
+
+        quickSort(arr, low, i, sink);
+        quickSort(arr, i + 2, high, sink);
+    }
+}
+
+template <StepSink Sink>
+void heapify(std::vector<int>& arr, int n, int i, Sink& sink) {
+    DepthScope scope;
+    int largest = i;
+    int left = 2 * i + 1;
+    int right = 2 * i + 2;
+
+    if (left < n) {
+        emitStep(sink, {StepOp::Compare, left, largest, 0});
+        if (arr[left] > arr[largest]) largest = left;
+    }
+    if (right < n) {
+        emitStep(sink, {StepOp::Compare, right, largest, 0});
+        if (arr[right] > arr[largest]) largest = right;
+    }
+
+    if (largest != i) {
+        std::swap(arr[i], arr[largest]);
+        emitStep(sink, {StepOp::Swap, largest, i, 0});
+        if (sink.stopped()) return;
+        heapify(arr, n, largest, sink);
+    }
+}
+
+template <StepSink Sink>
+void heapSort(std::vector<int>& arr, Sink& sink) {
+    int n = arr.size();
+    for (int i = n / 2 - 1; i >= 0; i--) {
+        if (sink.stopped()) return;
+        heapify(arr, n, i, sink);
+    }
+    for (int i = n - 1; i > 0; i--) {
+        if (sink.stopped()) return;
+        std::swap(arr[0], arr[i]);
+        emitStep(sink, {StepOp::Swap, i, 0, 0});
+        heapify(arr, i, 0, sink);
+    }
+}
+
+// The heap sorts below are iterative and move a hole instead of swapping: the
+// key being sifted is held aside while larger children move up into the hole,
+// and it is written once at the end. Their compares and writes are reported
+// as (node, root of the current sift), so a sink can draw the sift path.
+
+// Bottom-up heap sort (Floyd, Wegener): the hole first descends to a leaf
+// along the larger children, one comparison per level, and the key then
+// climbs back to its place. The key comes from the bottom of the heap and
+// nearly always belongs near a leaf, so the climb is short and the sort makes
+// about n log2(n) comparisons against 2 n log2(n) for the classic sift-down.
+template <StepSink Sink>
+void bottomUpHeapSort(std::vector<int>& arr, Sink& sink) {
+    int n = static_cast<int>(arr.size());
+    auto sift = [&](int root, int key, int size) {
+        int hole = root;
+        for (int child = 2 * hole + 1; child < size; child = 2 * hole + 1) {
+            if (sink.stopped()) return;
+            if (child + 1 < size) {
+                emitStep(sink, {StepOp::Compare, child + 1, root, 0});
+                if (arr[child + 1] > arr[child]) ++child;
+            }
+            arr[hole] = arr[child];
+            emitStep(sink, {StepOp::Write, hole, root, arr[hole]});
+            hole = child;
+        }
+        while (hole > root) {
+            int parent = (hole - 1) / 2;
+            emitStep(sink, {StepOp::Compare, parent, root, 0});
+            if (!(key > arr[parent])) break;
+            arr[hole] = arr[parent];
+            emitStep(sink, {StepOp::Write, hole, root, arr[hole]});
+            hole = parent;
+        }
+        arr[hole] = key;
+        emitStep(sink, {StepOp::Write, hole, root, key});
+    };
+    for (int i = n / 2 - 1; i >= 0; --i) {
+        if (sink.stopped()) return;
+        sift(i, arr[i], n);
+    }
+    for (int end = n - 1; end > 0; --end) {
+        if (sink.stopped()) return;
+        int key = arr[end];
+        arr[end] = arr[0];
+        emitStep(sink, {StepOp::Write, end, 0, arr[end]});
+        sift(0, key, end);
+    }
+}
+
+// Moves the k smallest keys of arr into arr[0, k), sorted. One pass that
+// keeps the k smallest seen so far; k is small.
+template <StepSink Sink>
+void selectSmallestPrefix(std::vector<int>& arr, int k, Sink& sink) {
+    insertionSortRange(arr, 0, k, sink);
+    for (int i = k; i < static_cast<int>(arr.size()); ++i) {
+        if (sink.stopped()) return;
+        emitStep(sink, {StepOp::Compare, i, k - 1, 0});
+        if (!(arr[i] < arr[k - 1])) continue;
+        std::swap(arr[i], arr[k - 1]);
+        emitStep(sink, {StepOp::Swap, i, k - 1, 0});
+        for (int j = k - 1; j > 0; --j) {
+            emitStep(sink, {StepOp::Compare, j, j - 1, 0});
+            if (!(arr[j] < arr[j - 1])) break;
+            std::swap(arr[j], arr[j - 1]);
+            emitStep(sink, {StepOp::Swap, j, j - 1, 0});
+        }
+    }
+}
+
+// Heap sort on a D-ary heap: the tree is log2(D) times shallower, and the D
+// children of a node are adjacent, so finding the largest costs D - 1
+// comparisons within one cache line. For a silent sink the heap starts a few
+// elements into the array, so that every group of children is aligned to
+// D ints and never straddles a line; those first elements are filled with the
+// smallest keys beforehand. Other sinks keep the heap at index 0, where its
+// layout is easiest to follow.
+template <int D, StepSink Sink>
+void dAryHeapSort(std::vector<int>& arr, Sink& sink) {
+    int n = static_cast<int>(arr.size());
+    int lo = 0;
+    if constexpr (sinkIsSilent<Sink>()) {
+        // Heap node k lives at arr[lo + k]; its first children sit at lo + 1.
+        auto firstChild = reinterpret_cast<std::uintptr_t>(arr.data() + 1) / sizeof(int);
+        lo = static_cast<int>((D - firstChild % D) % D);
+        if (lo >= n) lo = 0;
+        if (lo > 0) selectSmallestPrefix(arr, lo, sink);
+    }
+    int* heap = arr.data() + lo;
+    auto sift = [&](int root, int key, int size) {
+        int hole = root;
+        for (int first = D * hole + 1; first < size; first = D * hole + 1) {
+            if (sink.stopped()) return;
+            int best = first;
+            int last = std::min(first + D, size);
+            for (int child = first + 1; child < last; ++child) {
+                emitStep(sink, {StepOp::Compare, lo + child, lo + root, 0});
+                if (heap[child] > heap[best]) best = child;
+            }
+            emitStep(sink, {StepOp::Compare, lo + best, lo + root, 0});
+            if (!(heap[best] > key)) break;
+            heap[hole] = heap[best];
+            emitStep(sink, {StepOp::Write, lo + hole, lo + root, heap[hole]});
+            hole = best;
+        }
+        heap[hole] = key;
+        emitStep(sink, {StepOp::Write, lo + hole, lo + root, key});
+    };
+    int size = n - lo;
+    for (int i = (size - 2) / D; i >= 0; --i) {
+        if (sink.stopped()) return;
+        sift(i, heap[i], size);
+    }
+    for (int end = size - 1; end > 0; --end) {
+        if (sink.stopped()) return;
+        int key = heap[end];
+        heap[end] = heap[0];
+        emitStep(sink, {StepOp::Write, lo + end, lo, heap[end]});
+        sift(0, key, end);
+    }
+}
+
+// Shared state of one parallel run. Tasks on pool threads count into those
+// threads' opCounters, so every task folds its counts in here when it ends and
+// the caller adds the total to its own counters after the last join.
+struct ParallelRun {
+    TaskPool* pool = nullptr;  // null: run every task inline
+    std::mutex countersMtx;
+    OpCounters counters;
+
+    // Runs fn as a task of `group`, on the pool if there is one. depth is the
+    // caller's recursion depth, so maxDepth stays meaningful across tasks.
+    template <typename Fn>
+    void fork(TaskGroup& group, Fn fn) {
+        if (!pool) {
+            fn();
+            return;
+        }
+        int depth = opCounters.depth;
+        pool->spawn(group, [this, fn, depth] {
+            OpCounters outer = opCounters;
+            opCounters.reset();
+            opCounters.depth = opCounters.maxDepth = depth;
+            fn();
+            {
+                std::lock_guard<std::mutex> lock(countersMtx);
+                counters.add(opCounters);
+            }
+            opCounters = outer;
+        });
+    }
+
+    void join(TaskGroup& group) {
+        if (pool) pool->wait(group);
+    }
+
+    void finish() { opCounters.add(counters); }
+};
+
+// Below these sizes the parallel sorts stop forking tasks or splitting merges;
+// the task overhead would outweigh the work.
+const std::size_t PARALLEL_SORT_CUTOFF = 1 << 14;
+const std::size_t PARALLEL_MERGE_CUTOFF = 1 << 16;
+
+// Number of elements of a[0..na) among the first k outputs of a stable merge
+// of a and b (ties taken from a first). Lets a merge be cut into independent
+// pieces at any output position.
+inline std::size_t coRank(std::size_t k, const int* a, std::size_t na, const int* b, std::size_t nb) {
+    std::size_t lo = k > nb ? k - nb : 0;
+    std::size_t hi = std::min(k, na);
+    while (lo < hi) {
+        std::size_t i = lo + (hi - lo) / 2;
+        if (a[i] > b[k - i - 1]) {
+            hi = i;
+        } else {
+            lo = i + 1;
+        }
+    }
+    return lo;
+}
+
+// Merges the sorted runs [lo, mid) and [mid, hi) of arr. Large merges are cut
+// by co-ranking into one piece per pool thread and the pieces run as tasks.
+template <StepSink Sink>
+void parallelMerge(std::vector<int>& arr, std::vector<int>& scratch, int lo, int mid, int hi, Sink& sink, ParallelRun& run) {
+    std::copy(arr.begin() + lo, arr.begin() + hi, scratch.begin() + lo);
+    std::size_t total = hi - lo;
+    std::size_t pieces = run.pool && total >= PARALLEL_MERGE_CUTOFF ? run.pool->concurrency() : 1;
+    if (pieces <= 1) {
+        mergeRuns(arr, scratch, lo, mid, mid, hi, lo, sink);
+        return;
+    }
+
+    const int* left = scratch.data() + lo;
+    const int* right = scratch.data() + mid;
+    std::size_t nl = mid - lo;
+    std::size_t nr = hi - mid;
+    TaskGroup group;
+    std::size_t prevK = 0, prevI = 0;
+    for (std::size_t p = 1; p <= pieces; ++p) {
+        std::size_t k = total * p / pieces;
+        std::size_t i = coRank(k, left, nl, right, nr);
+        int a = lo + static_cast<int>(prevI), aEnd = lo + static_cast<int>(i);
+        int b = mid + static_cast<int>(prevK - prevI), bEnd = mid + static_cast<int>(k - i);
+        int out = lo + static_cast<int>(prevK);
+        run.fork(group, [&arr, &scratch, a, aEnd, b, bEnd, out, &sink] {
+            mergeRuns(arr, scratch, a, aEnd, b, bEnd, out, sink);
+        });
+        prevK = k;
+        prevI = i;
+    }
+    run.join(group);
+}
+
+template <StepSink Sink>
+void parallelMergeSort(std::vector<int>& arr, std::vector<int>& scratch, int lo, int hi, Sink& sink, ParallelRun& run) {
+    DepthScope scope;
+    if (hi - lo <= SORT_NETWORK_CUTOFF) {
+        networkSortRange(arr, lo, hi - lo, sink);
+        return;
+    }
+    int mid = lo + (hi - lo) / 2;
+    if (run.pool && static_cast<std::size_t>(hi - lo) >= PARALLEL_SORT_CUTOFF) {
+        TaskGroup group;
+        run.fork(group, [&arr, &scratch, lo, mid, &sink, &run] { parallelMergeSort(arr, scratch, lo, mid, sink, run); });
+        parallelMergeSort(arr, scratch, mid, hi, sink, run);
+        run.join(group);
+    } else {
+        parallelMergeSort(arr, scratch, lo, mid, sink, run);
+        parallelMergeSort(arr, scratch, mid, hi, sink, run);
+    }
+    if (sink.stopped()) return;
+    parallelMerge(arr, scratch, lo, mid, hi, sink, run);
+}
+
+// Merge sort that forks its halves onto the shared task pool and splits large
+// merges across it. One scratch buffer the size of the array serves the whole
+// run, as in mergeSort.
+template <StepSink Sink>
+void parallelMergeSort(std::vector<int>& arr, Sink& sink) {
+    ScratchArena arena;
+    std::vector<int>& scratch = arena.ints(arr.size());
+    ParallelRun run;
+    if constexpr (sinkIsConcurrent<Sink>()) {
+        TaskPool& pool = sharedTaskPool();
+        if (pool.concurrency() > 1) run.pool = &pool;
+    }
+    parallelMergeSort(arr, scratch, 0, static_cast<int>(arr.size()), sink, run);
+    run.finish();
+}
+
+// Partitions at most this long are finished by insertion sort.
+const int QUICKSORT_INSERTION_CUTOFF = 24;
+// From this length on the pivot is Tukey's ninther rather than a median of three.
+const int QUICKSORT_NINTHER_CUTOFF = 128;
+
+// Heap sort of arr[lo, hi) with an iterative sift-down; the introsort
+// fallback once a partition recursed too deep.
+template <StepSink Sink>
+void heapSortRange(std::vector<int>& arr, int lo, int hi, Sink& sink) {
+    int n = hi - lo;
+    auto siftDown = [&](int root, int size) {
+        while (2 * root + 1 < size) {
+            if (sink.stopped()) return;
+            int child = 2 * root + 1;
+            if (child + 1 < size) {
+                emitStep(sink, {StepOp::Compare, lo + child + 1, lo + child, 0});
+                if (arr[lo + child + 1] > arr[lo + child]) ++child;
+            }
+            emitStep(sink, {StepOp::Compare, lo + child, lo + root, 0});
+            if (!(arr[lo + child] > arr[lo + root])) return;
+            std::swap(arr[lo + root], arr[lo + child]);
+            emitStep(sink, {StepOp::Swap, lo + child, lo + root, 0});
+            root = child;
+        }
+    };
+    for (int i = n / 2 - 1; i >= 0; --i) siftDown(i, n);
+    for (int end = n - 1; end > 0; --end) {
+        if (sink.stopped()) return;
+        std::swap(arr[lo], arr[lo + end]);
+        emitStep(sink, {StepOp::Swap, lo + end, lo, 0});
+        siftDown(0, end);
+    }
+}
+
+// Index of the median of arr[a], arr[b] and arr[c].
+template <StepSink Sink>
+int medianOfThree(const std::vector<int>& arr, int a, int b, int c, Sink& sink) {
+    emitStep(sink, {StepOp::Compare, a, b, 0});
+    if (arr[a] > arr[b]) std::swap(a, b);
+    emitStep(sink, {StepOp::Compare, b, c, 0});
+    if (arr[b] <= arr[c]) return b;
+    emitStep(sink, {StepOp::Compare, a, c, 0});
+    return arr[a] > arr[c] ? a : c;
+}
+
+template <StepSink Sink>
+int choosePivot(const std::vector<int>& arr, int lo, int hi, Sink& sink) {
+    int n = hi - lo;
+    int mid = lo + n / 2;
+    if (n < QUICKSORT_NINTHER_CUTOFF) return medianOfThree(arr, lo, mid, hi - 1, sink);
+    int e = n / 8;
+    return medianOfThree(arr,
+                         medianOfThree(arr, lo, lo + e, lo + 2 * e, sink),
+                         medianOfThree(arr, mid - e, mid, mid + e, sink),
+                         medianOfThree(arr, hi - 1 - 2 * e, hi - 1 - e, hi - 1, sink), sink);
+}
+
+// Dutch-flag partition of arr[lo, hi) around the value at `pivot`. On return
+// [lo, lt) < pivot, [lt, gt) == pivot and [gt, hi) > pivot, so runs of equal
+// keys are finished in one pass instead of degrading to O(n^2).
+template <StepSink Sink>
+void partitionThreeWay(std::vector<int>& arr, int lo, int hi, int pivot, int& lt, int& gt, Sink& sink) {
+    emitStep(sink, {StepOp::Pivot, pivot, hi - 1, arr[pivot]});
+    std::swap(arr[lo], arr[pivot]);
+    emitStep(sink, {StepOp::Swap, lo, pivot, 0});
+    int v = arr[lo];
+    lt = lo;
+    gt = hi;
+    int i = lo + 1;
+    while (i < gt) {
+        if (sink.stopped()) return;
+        // arr[lt] always holds a key equal to the pivot.
+        emitStep(sink, {StepOp::Compare, i, lt, 0});
+        if (arr[i] < v) {
+            std::swap(arr[lt], arr[i]);
+            emitStep(sink, {StepOp::Swap, lt, i, 0});
+            ++lt;
+            ++i;
+        } else if (arr[i] > v) {
+            --gt;
+            std::swap(arr[i], arr[gt]);
+            emitStep(sink, {StepOp::Swap, i, gt, 0});
+        } else {
+            ++i;
+        }
+    }
+}
+
+template <StepSink Sink>
+void introQuickSort(std::vector<int>& arr, int lo, int hi, int depthLimit, Sink& sink, ParallelRun& run) {
+    DepthScope scope;
+    TaskGroup group;
+    // Recurse into one side and loop on the other, so the stack stays
+    // O(log n) even before the depth limit kicks in.
+    while (hi - lo > QUICKSORT_INSERTION_CUTOFF) {
+        if (sink.stopped()) break;
+        if (depthLimit-- == 0) {
+            heapSortRange(arr, lo, hi, sink);
+            break;
+        }
+        int lt, gt;
+        partitionThreeWay(arr, lo, hi, choosePivot(arr, lo, hi, sink), lt, gt, sink);
+        if (run.pool && static_cast<std::size_t>(hi - lo) >= PARALLEL_SORT_CUTOFF) {
+            run.fork(group, [&arr, lo, lt, depthLimit, &sink, &run] { introQuickSort(arr, lo, lt, depthLimit, sink, run); });
+            lo = gt;
+        } else if (lt - lo < hi - gt) {
+            introQuickSort(arr, lo, lt, depthLimit, sink, run);
+            lo = gt;
+        } else {
+            introQuickSort(arr, gt, hi, depthLimit, sink, run);
+            hi = lt;
+        }
+    }
+    if (hi - lo <= QUICKSORT_INSERTION_CUTOFF) insertionSortRange(arr, lo, hi, sink);
+    run.join(group);
+}
+
+// Introsort-style quicksort: ninther or median-of-three pivots, three-way
+// partitioning, insertion sort for short partitions and heap sort once a
+// partition recurses past 2 log2(n) levels. Large partitions are forked onto
+// the shared task pool.
+template <StepSink Sink>
+void parallelQuickSort(std::vector<int>& arr, Sink& sink) {
+    ParallelRun run;
+    if constexpr (sinkIsConcurrent<Sink>()) {
+        TaskPool& pool = sharedTaskPool();
+        if (pool.concurrency() > 1) run.pool = &pool;
+    }
+    int depthLimit = 0;
+    for (std::size_t n = arr.size(); n > 1; n >>= 1) depthLimit += 2;
+    introQuickSort(arr, 0, static_cast<int>(arr.size()), depthLimit, sink, run);
+    run.finish();
+}
+
+// Elements classified per block by the branchless partition. 64 keeps both
+// offset buffers in one cache line each.
+const int PDQSORT_BLOCK = 64;
+// Element moves after which partialInsertionSort gives up on a range.
+const int PDQSORT_PARTIAL_INSERTION_LIMIT = 8;
+
+// Orders arr[a] <= arr[b].
+template <StepSink Sink>
+void sort2(std::vector<int>& arr, int a, int b, Sink& sink) {
+    emitStep(sink, {StepOp::Compare, b, a, 0});
+    if (arr[b] < arr[a]) {
+        std::swap(arr[a], arr[b]);
+        emitStep(sink, {StepOp::Swap, a, b, 0});
+    }
+}
+
+template <StepSink Sink>
+void sort3(std::vector<int>& arr, int a, int b, int c, Sink& sink) {
+    sort2(arr, a, b, sink);
+    sort2(arr, b, c, sink);
+    sort2(arr, a, b, sink);
+}
+
+// Insertion sort of arr[lo, hi) that gives up once it has moved more than
+// PDQSORT_PARTIAL_INSERTION_LIMIT elements. Returns whether the range ended up sorted.
+template <StepSink Sink>
+bool partialInsertionSort(std::vector<int>& arr, int lo, int hi, Sink& sink) {
+    int moved = 0;
+    for (int i = lo + 1; i < hi; ++i) {
+        if (sink.stopped()) return true;
+        int key = arr[i];
+        int j = i - 1;
+        emitStep(sink, {StepOp::Compare, j, i, 0});
+        if (!(key < arr[j])) continue;
+        do {
+            arr[j + 1] = arr[j];
+            emitStep(sink, {StepOp::Write, j + 1, i, arr[j + 1]});
+            --j;
+            if (j < lo) break;
+            emitStep(sink, {StepOp::Compare, j, i, 0});
+        } while (key < arr[j]);
+        arr[j + 1] = key;
+        emitStep(sink, {StepOp::Write, j + 1, i, key});
+        moved += i - (j + 1);
+        if (moved > PDQSORT_PARTIAL_INSERTION_LIMIT) return false;
+    }
+    return true;
+}
+
+// Moves the misplaced elements recorded in two offset buffers across: the
+// left ones sit at first + offsetsL[i], the right ones at last - offsetsR[i].
+// When both sides hold the same number they are swapped pairwise, otherwise
+// they are rotated as one cycle, which costs one write per element instead
+// of three.
+template <StepSink Sink>
+void swapOffsets(std::vector<int>& arr, int first, int last, const unsigned char* offsetsL, const unsigned char* offsetsR,
+                 int num, bool useSwaps, Sink& sink) {
+    if (useSwaps) {
+        for (int i = 0; i < num; ++i) {
+            int l = first + offsetsL[i], r = last - offsetsR[i];
+            std::swap(arr[l], arr[r]);
+            emitStep(sink, {StepOp::Swap, l, r, 0});
+        }
+    } else if (num > 0) {
+        int l = first + offsetsL[0], r = last - offsetsR[0];
+        int tmp = arr[l];
+        arr[l] = arr[r];
+        emitStep(sink, {StepOp::Write, l, r, arr[l]});
+        for (int i = 1; i < num; ++i) {
+            l = first + offsetsL[i];
+            arr[r] = arr[l];
+            emitStep(sink, {StepOp::Write, r, l, arr[r]});
+            r = last - offsetsR[i];
+            arr[l] = arr[r];
+            emitStep(sink, {StepOp::Write, l, r, arr[l]});
+        }
+        arr[r] = tmp;
+        emitStep(sink, {StepOp::Write, r, l, tmp});
+    }
+}
+
+// Partitions arr[lo, hi) around the pivot at lo into [lo, p) < pivot and
+// [p + 1, hi) >= pivot with the pivot at p, and returns p. The scan is
+// BlockQuicksort's: each side classifies a block of PDQSORT_BLOCK elements
+// into an offset buffer with no branch on the comparison, then the misplaced
+// ones are exchanged in bulk. alreadyPartitioned is set when the first scan
+// found nothing out of place.
+template <StepSink Sink>
+int partitionRightBranchless(std::vector<int>& arr, int lo, int hi, bool& alreadyPartitioned, Sink& sink) {
+    int pivot = arr[lo];
+    int first = lo, last = hi;
+    // Skip the prefix and suffix that are already in place. arr[lo] guards the
+    // left scan only if the first element was out of place; then the right
+    // scan is bounded by it.
+    do {
+        ++first;
+        emitStep(sink, {StepOp::Compare, first, lo, 0});
+    } while (arr[first] < pivot);
+    if (first - 1 == lo) {
+        while (first < last) {
+            --last;
+            emitStep(sink, {StepOp::Compare, last, lo, 0});
+            if (arr[last] < pivot) break;
+        }
+    } else {
+        do {
+            --last;
+            emitStep(sink, {StepOp::Compare, last, lo, 0});
+        } while (!(arr[last] < pivot));
+    }
+    alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned) {
+        std::swap(arr[first], arr[last]);
+        emitStep(sink, {StepOp::Swap, first, last, 0});
+        ++first;
+    }
+
+    alignas(64) unsigned char offsetsL[PDQSORT_BLOCK];
+    alignas(64) unsigned char offsetsR[PDQSORT_BLOCK];
+    int numL = 0, numR = 0, startL = 0, startR = 0;
+    // [first, last) is still unclassified, minus a pending block on either side.
+    while (last - first > 2 * PDQSORT_BLOCK) {
+        if (sink.stopped()) return first - 1;
+        if (numL == 0) {
+            startL = 0;
+            for (int i = 0; i < PDQSORT_BLOCK; ++i) {
+                emitStep(sink, {StepOp::Compare, first + i, lo, 0});
+                offsetsL[numL] = static_cast<unsigned char>(i);
+                numL += !(arr[first + i] < pivot);
+            }
+        }
+        if (numR == 0) {
+            startR = 0;
+            for (int i = 0; i < PDQSORT_BLOCK; ++i) {
+                emitStep(sink, {StepOp::Compare, last - i - 1, lo, 0});
+                offsetsR[numR] = static_cast<unsigned char>(i + 1);
+                numR += arr[last - i - 1] < pivot;
+            }
+        }
+        int num = std::min(numL, numR);
+        swapOffsets(arr, first, last, offsetsL + startL, offsetsR + startR, num, numL == numR, sink);
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+        if (numL == 0) first += PDQSORT_BLOCK;
+        if (numR == 0) last -= PDQSORT_BLOCK;
+    }
+
+    // The tail: split what is left between the two sides, letting a side
+    // that still has a pending block keep it.
+    int sizeL = 0, sizeR = 0;
+    int unknown = (last - first) - ((numR || numL) ? PDQSORT_BLOCK : 0);
+    if (numR) {
+        sizeL = unknown;
+        sizeR = PDQSORT_BLOCK;
+    } else if (numL) {
+        sizeL = PDQSORT_BLOCK;
+        sizeR = unknown;
+    } else {
+        sizeL = unknown / 2;
+        sizeR = unknown - sizeL;
+    }
+    if (unknown && !numL) {
+        startL = 0;
+        for (int i = 0; i < sizeL; ++i) {
+            emitStep(sink, {StepOp::Compare, first + i, lo, 0});
+            offsetsL[numL] = static_cast<unsigned char>(i);
+            numL += !(arr[first + i] < pivot);
+        }
+    }
+    if (unknown && !numR) {
+        startR = 0;
+        for (int i = 0; i < sizeR; ++i) {
+            emitStep(sink, {StepOp::Compare, last - i - 1, lo, 0});
+            offsetsR[numR] = static_cast<unsigned char>(i + 1);
+            numR += arr[last - i - 1] < pivot;
+        }
+    }
+    int num = std::min(numL, numR);
+    swapOffsets(arr, first, last, offsetsL + startL, offsetsR + startR, num, numL == numR, sink);
+    numL -= num;
+    numR -= num;
+    startL += num;
+    startR += num;
+    if (numL == 0) first += sizeL;
+    if (numR == 0) last -= sizeR;
+
+    // At most one side has misplaced elements left; move them to the middle.
+    if (numL) {
+        while (numL--) {
+            int l = first + offsetsL[startL + numL];
+            --last;
+            std::swap(arr[l], arr[last]);
+            emitStep(sink, {StepOp::Swap, l, last, 0});
+        }
+        first = last;
+    }
+    if (numR) {
+        while (numR--) {
+            int r = last - offsetsR[startR + numR];
+            std::swap(arr[r], arr[first]);
+            emitStep(sink, {StepOp::Swap, r, first, 0});
+            ++first;
+        }
+    }
+
+    int p = first - 1;
+    std::swap(arr[lo], arr[p]);
+    emitStep(sink, {StepOp::Swap, lo, p, 0});
+    return p;
+}
+
+// Partitions arr[lo, hi) around the pivot at lo into [lo, p] <= pivot and
+// (p, hi) > pivot. Used when the pivot equals the key left of the range,
+// which means every key equal to it is already in its final place.
+template <StepSink Sink>
+int partitionLeft(std::vector<int>& arr, int lo, int hi, Sink& sink) {
+    int pivot = arr[lo];
+    int first = lo, last = hi;
+    auto greater = [&](int i) {
+        emitStep(sink, {StepOp::Compare, i, lo, 0});
+        return pivot < arr[i];
+    };
+    while (greater(--last)) {}
+    if (last + 1 == hi) {
+        while (first < last && !greater(++first)) {}
+    } else {
+        while (!greater(++first)) {}
+    }
+    while (first < last) {
+        if (sink.stopped()) return last;
+        std::swap(arr[first], arr[last]);
+        emitStep(sink, {StepOp::Swap, first, last, 0});
+        while (greater(--last)) {}
+        while (!greater(++first)) {}
+    }
+    std::swap(arr[lo], arr[last]);
+    emitStep(sink, {StepOp::Swap, lo, last, 0});
+    return last;
+}
+
+template <StepSink Sink>
+void pdqSort(std::vector<int>& arr, int lo, int hi, int badAllowed, bool leftmost, Sink& sink) {
+    DepthScope scope;
+    while (true) {
+        if (sink.stopped()) return;
+        int size = hi - lo;
+        if (size <= QUICKSORT_INSERTION_CUTOFF) {
+            insertionSortRange(arr, lo, hi, sink);
+            return;
+        }
+
+        // The pivot goes to lo: a median of three, or a ninther of medians.
+        int half = size / 2;
+        if (size >= QUICKSORT_NINTHER_CUTOFF) {
+            sort3(arr, lo, lo + half, hi - 1, sink);
+            sort3(arr, lo + 1, lo + half - 1, hi - 2, sink);
+            sort3(arr, lo + 2, lo + half + 1, hi - 3, sink);
+            sort3(arr, lo + half - 1, lo + half, lo + half + 1, sink);
+            std::swap(arr[lo], arr[lo + half]);
+            emitStep(sink, {StepOp::Swap, lo, lo + half, 0});
+        } else {
+            sort3(arr, lo + half, lo, hi - 1, sink);
+        }
+        emitStep(sink, {StepOp::Pivot, lo, hi - 1, arr[lo]});
+
+        // Not leftmost, arr[lo - 1] is an earlier pivot no greater than any
+        // key here. If it equals this pivot, all keys equal to it go left and
+        // are done; only the greater ones remain.
+        if (!leftmost) {
+            emitStep(sink, {StepOp::Compare, lo - 1, lo, 0});
+            if (!(arr[lo - 1] < arr[lo])) {
+                lo = partitionLeft(arr, lo, hi, sink) + 1;
+                continue;
+            }
+        }
+
+        bool alreadyPartitioned;
+        int p = partitionRightBranchless(arr, lo, hi, alreadyPartitioned, sink);
+        if (sink.stopped()) return;
+        int sizeL = p - lo, sizeR = hi - (p + 1);
+
+        if (sizeL < size / 8 || sizeR < size / 8) {
+            // A bad split: after log2(n) of them fall back to heap sort,
+            // otherwise swap a few keys around to break the pattern.
+            if (--badAllowed == 0) {
+                heapSortRange(arr, lo, hi, sink);
+                return;
+            }
+            auto exchange = [&](int a, int b) {
+                std::swap(arr[a], arr[b]);
+                emitStep(sink, {StepOp::Swap, a, b, 0});
+            };
+            if (sizeL >= QUICKSORT_INSERTION_CUTOFF) {
+                exchange(lo, lo + sizeL / 4);
+                exchange(p - 1, p - sizeL / 4);
+                if (sizeL > QUICKSORT_NINTHER_CUTOFF) {
+                    exchange(lo + 1, lo + sizeL / 4 + 1);
+                    exchange(lo + 2, lo + sizeL / 4 + 2);
+                    exchange(p - 2, p - (sizeL / 4 + 1));
+                    exchange(p - 3, p - (sizeL / 4 + 2));
+                }
+            }
+            if (sizeR >= QUICKSORT_INSERTION_CUTOFF) {
+                exchange(p + 1, p + 1 + sizeR / 4);
+                exchange(hi - 1, hi - sizeR / 4);
+                if (sizeR > QUICKSORT_NINTHER_CUTOFF) {
+                    exchange(p + 2, p + 2 + sizeR / 4);
+                    exchange(p + 3, p + 3 + sizeR / 4);
+                    exchange(hi - 2, hi - (1 + sizeR / 4));
+                    exchange(hi - 3, hi - (2 + sizeR / 4));
+                }
+            }
+        } else if (alreadyPartitioned && partialInsertionSort(arr, lo, p, sink) && partialInsertionSort(arr, p + 1, hi, sink)) {
+            // A balanced split that needed no swaps: the input is probably
+            // sorted already, and a cheap insertion pass has confirmed it.
+            return;
+        }
+
+        pdqSort(arr, lo, p, badAllowed, leftmost, sink);
+        lo = p + 1;
+        leftmost = false;
+    }
+}
+
+// Pattern-defeating quicksort. Partitions with the branchless block scheme,
+// finishes sorted or nearly sorted ranges with a bounded insertion pass,
+// handles runs of equal keys in one pass through partitionLeft, breaks up
+// patterns that cause bad splits and falls back to heap sort after log2(n)
+// of them.
+template <StepSink Sink>
+void pdqSort(std::vector<int>& arr, Sink& sink) {
+    int badAllowed = 0;
+    for (std::size_t n = arr.size(); n > 0; n >>= 1) ++badAllowed;
+    pdqSort(arr, 0, static_cast<int>(arr.size()), badAllowed, true, sink);
+}
+
+// Radix sorts work on the bytes of the key with the sign bit flipped, so
+// negative values order before positive ones.
+inline unsigned radixDigit(int v, int shift) {
+    return ((static_cast<uint32_t>(v) ^ 0x80000000u) >> shift) & 0xFF;
+}
+
+// One read pass builds the histograms of all four bytes. Each byte keeps two
+// tables that alternate between elements, so back-to-back increments of the
+// same counter do not wait on each other; they are summed at the end. The
+// tables are scratch like any other and are counted as an allocation.
+inline void radixHistograms(const std::vector<int>& arr, std::size_t counts[4][256]) {
+    std::vector<uint32_t> tables(2 * 4 * 256);
+    noteAllocation(tables.size() * sizeof(uint32_t));
+    uint32_t* even = tables.data();
+    uint32_t* odd = even + 4 * 256;
+    std::size_t n = arr.size();
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint32_t a = static_cast<uint32_t>(arr[i]) ^ 0x80000000u;
+        uint32_t b = static_cast<uint32_t>(arr[i + 1]) ^ 0x80000000u;
+        ++even[0 * 256 + (a & 0xFF)];
+        ++even[1 * 256 + ((a >> 8) & 0xFF)];
+        ++even[2 * 256 + ((a >> 16) & 0xFF)];
+        ++even[3 * 256 + (a >> 24)];
+        ++odd[0 * 256 + (b & 0xFF)];
+        ++odd[1 * 256 + ((b >> 8) & 0xFF)];
+        ++odd[2 * 256 + ((b >> 16) & 0xFF)];
+        ++odd[3 * 256 + (b >> 24)];
+    }
+    if (i < n) {
+        for (int pass = 0; pass < 4; ++pass) ++even[pass * 256 + radixDigit(arr[i], 8 * pass)];
+    }
+    for (int pass = 0; pass < 4; ++pass) {
+        for (int d = 0; d < 256; ++d) counts[pass][d] = even[pass * 256 + d] + odd[pass * 256 + d];
+    }
+}
+
+// Least-significant-digit radix sort, one stable counting pass per byte,
+// ping-ponging between the array and a scratch buffer. Bytes every key shares
+// are skipped. Writes are reported as (slot, start of its bucket) and only
+// when they land in the array.
+template <StepSink Sink>
+void lsdRadixSort(std::vector<int>& arr, Sink& sink) {
+    int n = static_cast<int>(arr.size());
+    ScratchArena arena;
+    std::vector<int>& buffer = arena.ints(arr.size());
+    std::size_t counts[4][256];
+    radixHistograms(arr, counts);
+
+    bool inArray = true;
+    for (int pass = 0; pass < 4; ++pass) {
+        int shift = 8 * pass;
+        if (counts[pass][radixDigit(arr[0], shift)] == arr.size()) continue;
+
+        int starts[256];
+        int next[256];
+        int sum = 0;
+        for (int d = 0; d < 256; ++d) {
+            starts[d] = next[d] = sum;
+            sum += static_cast<int>(counts[pass][d]);
+        }
+        std::vector<int>& src = inArray ? arr : buffer;
+        std::vector<int>& dst = inArray ? buffer : arr;
+        for (int i = 0; i < n; ++i) {
+            if (sink.stopped()) return;
+            unsigned d = radixDigit(src[i], shift);
+            int j = next[d]++;
+            dst[j] = src[i];
+            if (!inArray) emitStep(sink, {StepOp::Write, j, starts[d], dst[j]});
+        }
+        inArray = !inArray;
+    }
+    if (!inArray) {
+        for (int i = 0; i < n; ++i) {
+            if (sink.stopped()) return;
+            arr[i] = buffer[i];
+            emitStep(sink, {StepOp::Write, i, 0, arr[i]});
+        }
+    }
+}
+
+// Buckets at most this long are finished by insertion sort.
+const int MSD_RADIX_INSERTION_CUTOFF = 32;
+
+// In-place most-significant-digit radix sort of arr[lo, hi) from byte
+// `shift` down (American flag sort). Elements are moved into their buckets by
+// following permutation cycles; each placement is one Write reported as
+// (slot, start of its bucket). Then every bucket is sorted on the next byte.
+template <StepSink Sink>
+void msdRadixSort(std::vector<int>& arr, int lo, int hi, int shift, Sink& sink) {
+    DepthScope scope;
+    if (hi - lo <= MSD_RADIX_INSERTION_CUTOFF) {
+        insertionSortRange(arr, lo, hi, sink);
+        return;
+    }
+
+    int counts[256] = {};
+    for (int i = lo; i < hi; ++i) ++counts[radixDigit(arr[i], shift)];
+    // A byte every key shares needs no pass.
+    while (shift > 0 && counts[radixDigit(arr[lo], shift)] == hi - lo) {
+        shift -= 8;
+        std::fill(std::begin(counts), std::end(counts), 0);
+        for (int i = lo; i < hi; ++i) ++counts[radixDigit(arr[i], shift)];
+    }
+
+    int starts[257];
+    int heads[256];
+    starts[0] = lo;
+    for (int d = 0; d < 256; ++d) {
+        heads[d] = starts[d];
+        starts[d + 1] = starts[d] + counts[d];
+    }
+    for (int b = 0; b < 256; ++b) {
+        while (heads[b] < starts[b + 1]) {
+            if (sink.stopped()) return;
+            int v = arr[heads[b]];
+            unsigned d = radixDigit(v, shift);
+            while (d != static_cast<unsigned>(b)) {
+                if (sink.stopped()) return;
+                int j = heads[d]++;
+                std::swap(v, arr[j]);
+                emitStep(sink, {StepOp::Write, j, starts[d], arr[j]});
+                d = radixDigit(v, shift);
+            }
+            arr[heads[b]] = v;
+            emitStep(sink, {StepOp::Write, heads[b], starts[b], v});
+            ++heads[b];
+        }
+    }
+
+    if (shift == 0) return;
+    for (int b = 0; b < 256; ++b) {
+        if (starts[b + 1] - starts[b] > 1) msdRadixSort(arr, starts[b], starts[b + 1], shift - 8, sink);
+    }
+}
+
+template <StepSink Sink>
+void msdRadixSort(std::vector<int>& arr, Sink& sink) {
+    msdRadixSort(arr, 0, static_cast<int>(arr.size()), 24, sink);
+}
+
+// Bitonic sort of the whole array: the network padded to a power of two, with
+// comparators that would touch the padding left out. A silent sink sorts
+// aligned blocks of SORT_NETWORK_MAX keys with the SIMD kernel first and runs
+// only the wider stages element by element.
+template <StepSink Sink>
+void bitonicSort(std::vector<int>& arr, Sink& sink) {
+    int n = static_cast<int>(arr.size());
+    int padded = 2;
+    while (padded < n) padded *= 2;
+    int fromK = 2;
+    if constexpr (sinkIsSilent<Sink>()) {
+        for (int lo = 0; lo < n; lo += SORT_NETWORK_MAX) networkSortRange(arr, lo, std::min(SORT_NETWORK_MAX, n - lo), sink);
+        fromK = 2 * SORT_NETWORK_MAX;
+    }
+    networkStages(arr, 0, n, fromK, padded, sink);
+}
+
+const int SORT_ALGORITHM_COUNT = 17;
+
+inline const char* sortAlgorithmName(int option) {
+    static const char* const names[] = {"Selection Sort", "Insertion Sort", "Bubble Sort", "Merge Sort", "Quick Sort", "Heap Sort",
+                                        "Parallel Merge Sort", "Parallel Quick Sort", "Bottom-Up Merge Sort",
+                                        "LSD Radix Sort", "MSD Radix Sort", "Bitonic Sort",
+                                        "Pattern-Defeating Quick Sort", "Bottom-Up Heap Sort", "4-ary Heap Sort", "8-ary Heap Sort",
+                                        "Powersort"};
+    return option >= 1 && option <= SORT_ALGORITHM_COUNT ? names[option - 1] : "Unknown";
+}
+
+// Runs menu algorithm `option` (1-based, as shown in the menus) over the whole
+// array. Returns false for an unknown option.
+template <StepSink Sink>
+bool runSort(int option, std::vector<int>& arr, Sink& sink) {
+    if (arr.empty()) return option >= 1 && option <= SORT_ALGORITHM_COUNT;
+    switch (option) {
+        case 1: selectionSort(arr, sink); return true;
+        case 2: insertionSort(arr, sink); return true;
+        case 3: bubbleSort(arr, sink); return true;
+        case 4: mergeSort(arr, sink); return true;
+        case 5: quickSort(arr, 0, static_cast<int>(arr.size()) - 1, sink); return true;
+        case 6: heapSort(arr, sink); return true;
+        case 7: parallelMergeSort(arr, sink); return true;
+        case 8: parallelQuickSort(arr, sink); return true;
+        case 9: bottomUpMergeSort(arr, sink); return true;
+        case 10: lsdRadixSort(arr, sink); return true;
+        case 11: msdRadixSort(arr, sink); return true;
+        case 12: bitonicSort(arr, sink); return true;
+        case 13: pdqSort(arr, sink); return true;
+        case 14: bottomUpHeapSort(arr, sink); return true;
+        case 15: dAryHeapSort<4>(arr, sink); return true;
+        case 16: dAryHeapSort<8>(arr, sink); return true;
+        case 17: powerSort(arr, sink); return true;
+        default: return false;
+    }
+}
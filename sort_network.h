@@ -0,0 +1,197 @@
+#pragma once
+
+// Vectorized bitonic sorting networks for blocks of up to 64 ints. A block is
+// padded with INT_MAX to a power of two (at least 8), loaded into registers
+// and run through the network with min/max; comparators inside one register
+// become a shuffle, a min, a max and a blend. The AVX2 and SSE4.1 kernels are
+// compiled with target attributes and picked once at runtime from what the
+// CPU supports, with a scalar kernel as the fallback everywhere else.
+//
+// The network is the "flip" form of bitonic sort, in which every comparator
+// puts the smaller key first: for each block size k the first stage pairs i
+// with i ^ (k - 1), then stages k/4, k/8, ..., 1 pair i with i ^ j.
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SORT_NETWORK_X86 1
+#endif
+
+const int SORT_NETWORK_MAX = 64;
+
+// Comparators in a padded network of n = 2^m keys: n/2 per stage, m(m+1)/2 stages.
+inline uint64_t sortNetworkComparators(int n) {
+    int padded = 8, m = 3;
+    while (padded < n) {
+        padded *= 2;
+        ++m;
+    }
+    return static_cast<uint64_t>(padded / 2) * (m * (m + 1) / 2);
+}
+
+inline int sortNetworkPadded(int n) {
+    int padded = 8;
+    while (padded < n) padded *= 2;
+    return padded;
+}
+
+inline void sortNetworkScalar(int* a, int n) {
+    for (int k = 2; k <= n; k *= 2) {
+        for (int i = 0; i < n; ++i) {
+            int l = i ^ (k - 1);
+            if (l > i) {
+                int lo = std::min(a[i], a[l]), hi = std::max(a[i], a[l]);
+                a[i] = lo;
+                a[l] = hi;
+            }
+        }
+        for (int j = k / 4; j > 0; j /= 2) {
+            for (int i = 0; i < n; ++i) {
+                int l = i ^ j;
+                if (l > i) {
+                    int lo = std::min(a[i], a[l]), hi = std::max(a[i], a[l]);
+                    a[i] = lo;
+                    a[l] = hi;
+                }
+            }
+        }
+    }
+}
+
+#ifdef SORT_NETWORK_X86
+// Register-level network shared by both instruction sets, expanded inside
+// each target kernel so no vector is ever passed across a function compiled
+// for a different instruction set. V supplies the lane count, min/max, a full
+// reverse, the in-register flip stage for k <= LANES and the in-register
+// stage for j < LANES.
+#define SORT_NETWORK_REGISTERS(V, r, n)                                          \
+    do {                                                                         \
+        const int regs = (n) / V::LANES;                                         \
+        for (int k = 2; k <= (n); k *= 2) {                                      \
+            if (k <= V::LANES) {                                                 \
+                for (int x = 0; x < regs; ++x) r[x] = V::flip(r[x], k);         \
+            } else {                                                             \
+                int span = k / V::LANES;                                         \
+                for (int base = 0; base < regs; base += span) {                  \
+                    for (int p = 0; p < span / 2; ++p) {                         \
+                        V::Reg lo = r[base + p];                                 \
+                        V::Reg hi = V::reverse(r[base + span - 1 - p]);          \
+                        r[base + p] = V::min(lo, hi);                            \
+                        r[base + span - 1 - p] = V::reverse(V::max(lo, hi));     \
+                    }                                                            \
+                }                                                                \
+            }                                                                    \
+            for (int j = k / 4; j > 0; j /= 2) {                                 \
+                if (j >= V::LANES) {                                             \
+                    int d = j / V::LANES;                                        \
+                    for (int x = 0; x < regs; ++x) {                             \
+                        if (x & d) continue;                                     \
+                        V::Reg lo = r[x], hi = r[x + d];                         \
+                        r[x] = V::min(lo, hi);                                   \
+                        r[x + d] = V::max(lo, hi);                               \
+                    }                                                            \
+                } else {                                                         \
+                    for (int x = 0; x < regs; ++x) r[x] = V::exchange(r[x], j); \
+                }                                                                \
+            }                                                                    \
+        }                                                                        \
+    } while (0)
+
+struct Sse41Lanes {
+    using Reg = __m128i;
+    static const int LANES = 4;
+
+    __attribute__((target("sse4.1"), always_inline)) static Reg min(Reg a, Reg b) { return _mm_min_epi32(a, b); }
+    __attribute__((target("sse4.1"), always_inline)) static Reg max(Reg a, Reg b) { return _mm_max_epi32(a, b); }
+    __attribute__((target("sse4.1"), always_inline)) static Reg reverse(Reg a) { return _mm_shuffle_epi32(a, _MM_SHUFFLE(0, 1, 2, 3)); }
+
+    // Lanes whose bit j is set take the max of the pair, the others the min.
+    __attribute__((target("sse4.1"), always_inline)) static Reg exchange(Reg a, int j) {
+        Reg b = j == 1 ? _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)) : _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+        Reg lo = _mm_min_epi32(a, b), hi = _mm_max_epi32(a, b);
+        return j == 1 ? _mm_blend_epi16(lo, hi, 0xCC) : _mm_blend_epi16(lo, hi, 0xF0);
+    }
+
+    __attribute__((target("sse4.1"), always_inline)) static Reg flip(Reg a, int k) {
+        if (k == 2) return exchange(a, 1);
+        Reg b = reverse(a);
+        return _mm_blend_epi16(_mm_min_epi32(a, b), _mm_max_epi32(a, b), 0xF0);
+    }
+};
+
+struct Avx2Lanes {
+    using Reg = __m256i;
+    static const int LANES = 8;
+
+    __attribute__((target("avx2"), always_inline)) static Reg min(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+    __attribute__((target("avx2"), always_inline)) static Reg max(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+    __attribute__((target("avx2"), always_inline)) static Reg reverse(Reg a) {
+        return _mm256_permutevar8x32_epi32(a, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    __attribute__((target("avx2"), always_inline)) static Reg exchange(Reg a, int j) {
+        Reg b;
+        if (j == 1) {
+            b = _mm256_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1));
+        } else if (j == 2) {
+            b = _mm256_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+        } else {
+            b = _mm256_permute2x128_si256(a, a, 1);
+        }
+        Reg lo = _mm256_min_epi32(a, b), hi = _mm256_max_epi32(a, b);
+        if (j == 1) return _mm256_blend_epi32(lo, hi, 0xAA);
+        if (j == 2) return _mm256_blend_epi32(lo, hi, 0xCC);
+        return _mm256_blend_epi32(lo, hi, 0xF0);
+    }
+
+    __attribute__((target("avx2"), always_inline)) static Reg flip(Reg a, int k) {
+        if (k == 2) return exchange(a, 1);
+        Reg b = k == 4 ? _mm256_shuffle_epi32(a, _MM_SHUFFLE(0, 1, 2, 3)) : reverse(a);
+        Reg lo = _mm256_min_epi32(a, b), hi = _mm256_max_epi32(a, b);
+        return k == 4 ? _mm256_blend_epi32(lo, hi, 0xCC) : _mm256_blend_epi32(lo, hi, 0xF0);
+    }
+};
+
+__attribute__((target("sse4.1"))) inline void sortNetworkSse41(int* a, int n) {
+    __m128i r[SORT_NETWORK_MAX / 4];
+    for (int x = 0; x < n / 4; ++x) r[x] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 4 * x));
+    SORT_NETWORK_REGISTERS(Sse41Lanes, r, n);
+    for (int x = 0; x < n / 4; ++x) _mm_storeu_si128(reinterpret_cast<__m128i*>(a + 4 * x), r[x]);
+}
+
+__attribute__((target("avx2"))) inline void sortNetworkAvx2(int* a, int n) {
+    __m256i r[SORT_NETWORK_MAX / 8];
+    for (int x = 0; x < n / 8; ++x) r[x] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 8 * x));
+    SORT_NETWORK_REGISTERS(Avx2Lanes, r, n);
+    for (int x = 0; x < n / 8; ++x) _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + 8 * x), r[x]);
+}
+#endif
+
+using SortNetworkKernel = void (*)(int*, int);
+
+// Kernel for this CPU, chosen on first use.
+inline SortNetworkKernel sortNetworkKernel() {
+    static const SortNetworkKernel kernel = [] {
+#ifdef SORT_NETWORK_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return static_cast<SortNetworkKernel>(sortNetworkAvx2);
+        if (__builtin_cpu_supports("sse4.1")) return static_cast<SortNetworkKernel>(sortNetworkSse41);
+#endif
+        return static_cast<SortNetworkKernel>(sortNetworkScalar);
+    }();
+    return kernel;
+}
+
+// Sorts p[0, n) for n <= SORT_NETWORK_MAX.
+inline void sortNetworkBlock(int* p, int n) {
+    int padded = sortNetworkPadded(n);
+    alignas(32) int block[SORT_NETWORK_MAX];
+    std::copy(p, p + n, block);
+    std::fill(block + n, block + padded, INT_MAX);
+    sortNetworkKernel()(block, padded);
+    std::copy(block, block + n, p);
+}
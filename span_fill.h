@@ -0,0 +1,34 @@
+#pragma once
+
+// Fills runs of 32-bit pixels for the CPU rasterizer. Bars are drawn as one
+// horizontal span per bar per row, so the fill is the whole inner loop; it
+// uses AVX2 or SSE2 stores when the compiler targets them and plain scalar
+// code otherwise.
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SPAN_FILL_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPAN_FILL_SSE2 1
+#endif
+
+// Sets p[0..count) to value. p needs no particular alignment.
+inline void fillSpan(uint32_t* p, std::size_t count, uint32_t value) {
+    std::size_t i = 0;
+#if defined(SPAN_FILL_AVX2)
+    __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), v);
+    }
+#elif defined(SPAN_FILL_SSE2)
+    __m128i v = _mm_set1_epi32(static_cast<int>(value));
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), v);
+    }
+#endif
+    for (; i < count; ++i) p[i] = value;
+}
@@ -0,0 +1,304 @@
+#include "step_trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void putU16(std::vector<uint8_t>& buf, uint16_t v) {
+    for (int i = 0; i < 2; ++i) buf.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+void putU32(std::vector<uint8_t>& buf, uint32_t v) {
+    for (int i = 0; i < 4; ++i) buf.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+void putU64(std::vector<uint8_t>& buf, uint64_t v) {
+    for (int i = 0; i < 8; ++i) buf.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+uint64_t getU64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+uint32_t pickKeyframeInterval(std::size_t elements) {
+    uint64_t spacing = static_cast<uint64_t>(elements) * TRACE_KEYFRAME_SPACING;
+    return static_cast<uint32_t>(std::clamp<uint64_t>(spacing, TRACE_MIN_KEYFRAME_INTERVAL, UINT32_MAX));
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder(const std::string& path, int algorithm, const std::vector<int>& initialArr, uint32_t keyframeInterval)
+    : out(path, std::ios::binary | std::ios::trunc),
+      shadow(initialArr),
+      interval(keyframeInterval ? keyframeInterval : pickKeyframeInterval(initialArr.size())),
+      untilKeyframe(interval) {
+    buffer.reserve(FLUSH_THRESHOLD + 32);
+    buffer.insert(buffer.end(), {'A', 'V', 'Z', 'T'});
+    buffer.push_back(TRACE_VERSION);
+    buffer.push_back(static_cast<uint8_t>(algorithm));
+    putU16(buffer, 0);
+    putU64(buffer, initialArr.size());
+    putU64(buffer, 0);  // step count, patched by finish()
+    putU64(buffer, 0);  // index offset, patched by finish()
+    putU32(buffer, interval);
+    putU32(buffer, 0);
+    for (int v : initialArr) {
+        if (buffer.size() > FLUSH_THRESHOLD) flush();
+        putVarint(zigzagEncode(v));
+    }
+}
+
+TraceRecorder::~TraceRecorder() {
+    finish();
+}
+
+void TraceRecorder::flush() {
+    if (!buffer.empty() && out) {
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        written += buffer.size();
+    }
+    buffer.clear();
+}
+
+void TraceRecorder::putKeyframe() {
+    keyframes.push_back({steps, written + buffer.size()});
+    buffer.push_back(TRACE_KEYFRAME);
+    for (int v : shadow) {
+        if (buffer.size() > FLUSH_THRESHOLD) flush();
+        putVarint(zigzagEncode(v));
+    }
+    lastA = 0;
+    untilKeyframe = interval;
+}
+
+bool TraceRecorder::finish() {
+    if (finished) return static_cast<bool>(out);
+    finished = true;
+
+    uint64_t indexOffset = written + buffer.size();
+    putU64(buffer, keyframes.size());
+    for (const auto& kf : keyframes) {
+        if (buffer.size() > FLUSH_THRESHOLD) flush();
+        putU64(buffer, kf.step);
+        putU64(buffer, kf.offset);
+    }
+    flush();
+
+    std::vector<uint8_t> patch;
+    putU64(patch, steps);
+    putU64(patch, indexOffset);
+    out.seekp(16);
+    out.write(reinterpret_cast<const char*>(patch.data()), patch.size());
+    out.close();
+    return !out.fail();
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+    fileHandle = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) return;
+    mappingHandle = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) return;
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<std::size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+}
+#else
+MappedFile::MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            bytes = static_cast<const uint8_t*>(view);
+            length = static_cast<std::size_t>(st.st_size);
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) munmap(const_cast<uint8_t*>(bytes), length);
+}
+#endif
+
+TraceReader::TraceReader(const std::string& path) : file(path) {
+    if (!file.ok()) {
+        fail("Could not open trace file " + path);
+        return;
+    }
+    const uint8_t* p = file.data();
+    if (file.size() < TRACE_HEADER_SIZE_V1 || std::memcmp(p, "AVZT", 4) != 0) {
+        fail("Not a trace file: " + path);
+        return;
+    }
+    // Version 1 traces have no keyframes; seeking in them replays from the start.
+    uint8_t version = p[4];
+    if (version != 1 && version != TRACE_VERSION) {
+        fail("Unsupported trace version " + std::to_string(version));
+        return;
+    }
+    std::size_t headerSize = version == 1 ? TRACE_HEADER_SIZE_V1 : TRACE_HEADER_SIZE;
+    if (file.size() < headerSize) {
+        fail("Trace truncated in the header");
+        return;
+    }
+    algorithmId = p[5];
+    uint64_t elements = getU64(p + 8);
+    steps = getU64(p + 16);
+
+    cursor = p + headerSize;
+    end = p + file.size();
+    if (version != 1) {
+        uint64_t indexOffset = getU64(p + 24);
+        if (!readIndex(indexOffset)) return;
+        end = p + indexOffset;
+    }
+    if (elements > static_cast<uint64_t>(end - cursor)) {
+        fail("Trace header claims more elements than the file holds");
+        return;
+    }
+    initial.resize(elements);
+    if (!readArray(initial)) {
+        fail("Trace truncated in the initial array");
+        return;
+    }
+    body = cursor;
+    valid = true;
+}
+
+bool TraceReader::fail(const std::string& message) {
+    errorMessage = message;
+    valid = false;
+    return false;
+}
+
+bool TraceReader::readIndex(uint64_t indexOffset) {
+    const uint8_t* p = file.data();
+    if (indexOffset < TRACE_HEADER_SIZE || indexOffset + 8 > file.size()) {
+        return fail("Trace has no keyframe index (recording was interrupted?)");
+    }
+    uint64_t count = getU64(p + indexOffset);
+    if (count > (file.size() - indexOffset - 8) / 16) return fail("Trace keyframe index is truncated");
+    keyframes.resize(count);
+    for (uint64_t k = 0; k < count; ++k) {
+        const uint8_t* entry = p + indexOffset + 8 + 16 * k;
+        keyframes[k] = {getU64(entry), getU64(entry + 8)};
+        if (keyframes[k].offset >= indexOffset) return fail("Trace keyframe index points past the step stream");
+    }
+    return true;
+}
+
+bool TraceReader::getVarint(uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && cursor < end; shift += 7) {
+        uint8_t byte = *cursor++;
+        v |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool TraceReader::readArray(std::vector<int>& arr) {
+    for (auto& v : arr) {
+        uint32_t raw;
+        if (!getVarint(raw)) return false;
+        v = zigzagDecode(raw);
+    }
+    return true;
+}
+
+bool TraceReader::next(Step& step) {
+    if (!valid || stepIndex >= steps || cursor >= end) return false;
+
+    uint8_t op = *cursor++;
+    if (op == TRACE_KEYFRAME) {
+        // Forward playback already has the array; just step over the snapshot.
+        for (std::size_t i = 0; i < initial.size(); ++i) {
+            uint32_t skipped;
+            if (!getVarint(skipped)) return fail("Trace truncated in a keyframe");
+        }
+        lastA = 0;
+        if (cursor >= end) return false;
+        op = *cursor++;
+    }
+    if (op > static_cast<uint8_t>(StepOp::Pivot)) return fail("Corrupt step opcode in trace");
+    uint32_t da, db, value = 0;
+    if (!getVarint(da) || !getVarint(db)) return fail("Trace truncated mid-step");
+    step.op = static_cast<StepOp>(op);
+    if (stepHasValue(step.op) && !getVarint(value)) return fail("Trace truncated mid-step");
+
+    step.a = lastA + zigzagDecode(da);
+    step.b = step.a + zigzagDecode(db);
+    step.value = zigzagDecode(value);
+    if (step.a < 0 || static_cast<std::size_t>(step.a) >= initial.size()) return fail("Step index out of range in trace");
+    if (step.op == StepOp::Swap && (step.b < 0 || static_cast<std::size_t>(step.b) >= initial.size())) {
+        return fail("Step index out of range in trace");
+    }
+    lastA = step.a;
+    ++stepIndex;
+    return true;
+}
+
+void TraceReader::rewind() {
+    cursor = body;
+    stepIndex = 0;
+    lastA = 0;
+}
+
+bool TraceReader::seek(uint64_t target, std::vector<int>& arr) {
+    if (!valid) return false;
+    target = std::min(target, steps);
+
+    // Nearest keyframe at or before the target; moving forward from the
+    // current position is cheaper when it is already past that keyframe.
+    auto kf = std::upper_bound(keyframes.begin(), keyframes.end(), target,
+                               [](uint64_t t, const TraceKeyframe& k) { return t < k.step; });
+    bool useKeyframe = kf != keyframes.begin() && std::prev(kf)->step > stepIndex;
+    if (useKeyframe || target < stepIndex) {
+        if (kf == keyframes.begin()) {
+            rewind();
+            arr = initial;
+        } else {
+            --kf;
+            cursor = file.data() + kf->offset + 1;
+            arr.resize(initial.size());
+            if (!readArray(arr)) return fail("Trace truncated in a keyframe");
+            stepIndex = kf->step;
+            lastA = 0;
+        }
+    }
+
+    Step step;
+    while (stepIndex < target && next(step)) {
+        applyStep(arr, step);
+    }
+    return valid;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+// Compact binary step traces. A TraceRecorder is a sink that streams the
+// engine's steps to disk; a TraceReader memory-maps the file and hands the
+// steps back one at a time, so a run can be recorded at native speed and
+// replayed through the visualizer later.
+//
+// File layout (all multi-byte header fields little-endian):
+//   "AVZT"  u8 version  u8 algorithm  u16 reserved  u64 elements  u64 steps
+//   u64 index offset  u32 keyframe interval  u32 reserved          (v2 only)
+//   elements x zigzag varint      initial array
+//   steps x { u8 op, varint a-delta, varint b-a, [varint value] }
+//   index: u64 count, count x { u64 step, u64 offset }              (v2 only)
+// a is stored relative to the previous step's a and b relative to a, so the
+// neighbouring indices most algorithms touch encode in one byte each. Only
+// Write and Pivot steps carry a value.
+//
+// Every `keyframe interval` steps the stream also holds a keyframe record
+// (TRACE_KEYFRAME followed by the whole array as zigzag varints, after which
+// the a-delta restarts from 0). The index at the end of the file lists where
+// each keyframe sits, so seeking to step s costs one keyframe decode plus at
+// most one interval of steps instead of a replay from the beginning.
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "sort_engine.h"
+
+const uint8_t TRACE_VERSION = 2;
+const std::size_t TRACE_HEADER_SIZE_V1 = 24;
+const std::size_t TRACE_HEADER_SIZE = 40;
+const uint8_t TRACE_KEYFRAME = 0x80;
+
+// Keyframes cost about one array's worth of bytes each, so by default they are
+// spaced a few array lengths apart to keep them a small fraction of the trace.
+const uint32_t TRACE_MIN_KEYFRAME_INTERVAL = 4096;
+const uint32_t TRACE_KEYFRAME_SPACING = 4;
+
+inline uint32_t zigzagEncode(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+inline int32_t zigzagDecode(uint32_t v) {
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+inline bool stepHasValue(StepOp op) {
+    return op == StepOp::Write || op == StepOp::Pivot;
+}
+
+// Applies a step's effect to an array; Compare and Pivot leave it untouched.
+inline void applyStep(std::vector<int>& arr, const Step& step) {
+    if (step.op == StepOp::Swap) {
+        std::swap(arr[step.a], arr[step.b]);
+    } else if (step.op == StepOp::Write) {
+        arr[step.a] = step.value;
+    }
+}
+
+struct TraceKeyframe {
+    uint64_t step;    // number of steps applied before this keyframe
+    uint64_t offset;  // byte offset of the keyframe record
+};
+
+class TraceRecorder {
+public:
+    // keyframeInterval = 0 picks a spacing based on the array length.
+    TraceRecorder(const std::string& path, int algorithm, const std::vector<int>& initial, uint32_t keyframeInterval = 0);
+    ~TraceRecorder();
+
+    void emit(const Step& step) {
+        if (untilKeyframe == 0) putKeyframe();
+        if (buffer.size() > FLUSH_THRESHOLD) flush();
+        buffer.push_back(static_cast<uint8_t>(step.op));
+        putVarint(zigzagEncode(step.a - lastA));
+        putVarint(zigzagEncode(step.b - step.a));
+        if (stepHasValue(step.op)) putVarint(zigzagEncode(step.value));
+        applyStep(shadow, step);
+        lastA = step.a;
+        ++steps;
+        --untilKeyframe;
+    }
+
+    constexpr bool stopped() const { return false; }
+
+    // Writes the remaining buffer and the keyframe index, then patches the
+    // header. Returns false if the file could not be written.
+    bool finish();
+
+    bool ok() const { return static_cast<bool>(out); }
+    uint64_t stepCount() const { return steps; }
+    uint64_t bytesWritten() const { return written; }
+    std::size_t keyframeCount() const { return keyframes.size(); }
+
+private:
+    static const std::size_t FLUSH_THRESHOLD = 1 << 16;
+
+    void putVarint(uint32_t v) {
+        while (v >= 0x80) {
+            buffer.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        buffer.push_back(static_cast<uint8_t>(v));
+    }
+
+    void putKeyframe();
+    void flush();
+
+    std::ofstream out;
+    std::vector<uint8_t> buffer;
+    std::vector<int> shadow;
+    std::vector<TraceKeyframe> keyframes;
+    int lastA = 0;
+    uint32_t interval;
+    uint32_t untilKeyframe;
+    uint64_t steps = 0;
+    uint64_t written = 0;
+    bool finished = false;
+};
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return bytes; }
+    std::size_t size() const { return length; }
+    bool ok() const { return bytes != nullptr; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path);
+
+    // False if the file is missing, truncated or not a trace.
+    bool ok() const { return valid; }
+    const std::string& error() const { return errorMessage; }
+
+    int algorithm() const { return algorithmId; }
+    uint64_t stepCount() const { return steps; }
+    const std::vector<int>& initialArray() const { return initial; }
+    std::size_t keyframeCount() const { return keyframes.size(); }
+
+    // Decodes the next step; false once the stream is exhausted or malformed.
+    bool next(Step& step);
+    void rewind();
+    uint64_t position() const { return stepIndex; }
+
+    // Puts arr in the state it had after `target` steps (clamped to the trace
+    // length) and positions the reader so next() returns the following step.
+    // When seeking forward without a keyframe in between, arr must hold the
+    // state at position(), as it does for a caller that applies every step.
+    bool seek(uint64_t target, std::vector<int>& arr);
+
+private:
+    bool getVarint(uint32_t& v);
+    bool readArray(std::vector<int>& arr);
+    bool readIndex(uint64_t indexOffset);
+    bool fail(const std::string& message);
+
+    MappedFile file;
+    std::vector<int> initial;
+    std::vector<TraceKeyframe> keyframes;
+    std::string errorMessage;
+    const uint8_t* body = nullptr;
+    const uint8_t* cursor = nullptr;
+    const uint8_t* end = nullptr;
+    uint64_t steps = 0;
+    uint64_t stepIndex = 0;
+    int algorithmId = 0;
+    int lastA = 0;
+    bool valid = false;
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+// Work-stealing task pool for the parallel sorts. Every worker owns a deque:
+// it pushes and pops its own tasks at the back, so the half it forked last
+// (and whose data is still in cache) runs next, while idle workers steal from
+// the front of the other deques, where the oldest and usually largest tasks
+// sit. Threads outside the pool push into one extra shared deque.
+//
+// A thread that waits on a TaskGroup runs queued tasks instead of blocking,
+// so nested fork/join never deadlocks and the waiting thread does useful work.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the tasks spawned into it that have not finished yet.
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+private:
+    friend class TaskPool;
+    std::atomic<int> pending{0};
+};
+
+class TaskPool {
+public:
+    // `threads` counts the caller too, so TaskPool(1) starts no workers and
+    // runs everything on the thread that waits.
+    explicit TaskPool(unsigned threads) {
+        unsigned workers = std::max(threads, 1u) - 1;
+        for (unsigned i = 0; i <= workers; ++i) queues.push_back(std::make_unique<Queue>());
+        for (unsigned i = 0; i < workers; ++i) threadsRunning.emplace_back(&TaskPool::workerLoop, this, static_cast<int>(i));
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threadsRunning) thread.join();
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // Threads that can run tasks at once: the workers plus one waiting caller.
+    unsigned concurrency() const { return static_cast<unsigned>(threadsRunning.size()) + 1; }
+
+    void spawn(TaskGroup& group, std::function<void()> fn) {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        Queue& queue = *queues[ownQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mtx);
+            queue.tasks.push_back({&group, std::move(fn)});
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        {
+            // Pairs with the predicate check in workerLoop so a worker about
+            // to sleep cannot miss this task.
+            std::lock_guard<std::mutex> lock(sleepMtx);
+        }
+        wake.notify_one();
+    }
+
+    // Returns once every task spawned into `group` has finished, running
+    // queued tasks (of any group) in the meantime.
+    void wait(TaskGroup& group) {
+        int self = ownQueue();
+        while (group.pending.load(std::memory_order_acquire) > 0) {
+            if (!runOne(self)) std::this_thread::yield();
+        }
+    }
+
+private:
+    struct Task {
+        TaskGroup* group;
+        std::function<void()> fn;
+    };
+
+    struct Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    // Index of the calling thread's deque; the last one is shared by every
+    // thread outside the pool.
+    int ownQueue() const {
+        return currentPool == this ? currentWorker : static_cast<int>(queues.size()) - 1;
+    }
+
+    bool take(int index, bool own, Task& task) {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mtx);
+        if (queue.tasks.empty()) return false;
+        if (own) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+
+    // Runs one task from the caller's own deque, or else one stolen from
+    // another; false if every deque was empty.
+    bool runOne(int self) {
+        Task task;
+        bool found = take(self, true, task);
+        int count = static_cast<int>(queues.size());
+        for (int k = 1; !found && k < count; ++k) {
+            found = take((self + k) % count, false, task);
+        }
+        if (!found) return false;
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        task.fn();
+        task.group->pending.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void workerLoop(int index) {
+        currentPool = this;
+        currentWorker = index;
+        while (true) {
+            if (runOne(index)) continue;
+            std::unique_lock<std::mutex> lock(sleepMtx);
+            wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+            if (stopping) return;
+        }
+    }
+
+    static inline thread_local const TaskPool* currentPool = nullptr;
+    static inline thread_local int currentWorker = -1;
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threadsRunning;
+    std::atomic<int> queued{0};
+    std::mutex sleepMtx;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+// Pool shared by every parallel sort, one thread per core by default.
+// Resize only while no parallel sort is running.
+inline std::mutex& taskPoolMutex() {
+    static std::mutex mtx;
+    return mtx;
+}
+
+inline std::unique_ptr<TaskPool>& taskPoolInstance() {
+    static std::unique_ptr<TaskPool> pool;
+    return pool;
+}
+
+inline TaskPool& sharedTaskPool() {
+    std::lock_guard<std::mutex> lock(taskPoolMutex());
+    auto& pool = taskPoolInstance();
+    if (!pool) pool = std::make_unique<TaskPool>(std::max(std::thread::hardware_concurrency(), 1u));
+    return *pool;
+}
+
+inline void resizeSharedTaskPool(unsigned threads) {
+    std::lock_guard<std::mutex> lock(taskPoolMutex());
+    taskPoolInstance() = std::make_unique<TaskPool>(threads);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// Single-producer / single-consumer triple buffer. The writer fills the back
+// buffer and publishes it with one atomic exchange; the reader picks up the
+// newest complete buffer with another. Neither side ever waits for the other,
+// and the reader never sees a half-written value.
+
+#include <atomic>
+#include <cstdint>
+
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side: fill writeBuffer(), then publish().
+    T& writeBuffer() { return buffers[back]; }
+
+    void publish() {
+        back = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side: consume() swaps in the newest published buffer if there is
+    // one and returns whether it did; readBuffer() is the current frame either way.
+    bool consume() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[front]; }
+
+    // Only valid while neither side is running.
+    void reset() {
+        for (auto& buffer : buffers) buffer = T{};
+        front = 0;
+        middle.store(1, std::memory_order_relaxed);
+        back = 2;
+    }
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH = 0x4;
+
+    T buffers[3];
+    uint8_t front = 0;
+    std::atomic<uint8_t> middle{1};
+    uint8_t back = 2;
+};